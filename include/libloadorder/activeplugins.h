@@ -79,6 +79,35 @@ extern "C"
                                              char *** const plugins,
                                              size_t * const numPlugins);
 
+    /**
+     *  @brief Copies the list of currently active plugins into a
+     *         caller-supplied buffer.
+     *  @details Writes the currently active plugins into the given buffer as
+     *           consecutive null-terminated plugin filenames, avoiding any
+     *           allocation by libloadorder. The size the filenames need is
+     *           always outputted, so a first call with a `NULL` buffer can
+     *           be used to size the buffer for a second call. If the buffer
+     *           is not `NULL` but is too small, nothing is written to it and
+     *           ::LIBLO_ERROR_INVALID_ARGS is returned.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @param buffer
+     *      The buffer to write the plugin filenames to, or `NULL`.
+     *  @param bufferSize
+     *      The size of the buffer in bytes.
+     *  @param requiredSize
+     *      A pointer to the outputted size in bytes that the plugin filenames
+     *      need, including their null terminators.
+     *  @param numPlugins
+     *      A pointer to the outputted number of active plugins.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_copy_active_plugins(lo_game_handle gh,
+                                              char * const buffer,
+                                              const size_t bufferSize,
+                                              size_t * const requiredSize,
+                                              size_t * const numPlugins);
+
     /**
      *  @brief Sets the list of currently active plugins.
      *  @details Replaces the current active plugins list with the plugins in
@@ -73,8 +73,9 @@ extern "C"
      *  @details Used to keep each game's data independent. Abstracts the
      *           definition of libloadorder's internal state while still
      *           providing type safety across the library. Multiple handles
-     *           can also be made for each game, though it should be kept in
-     *           mind that libloadorder is not thread-safe.
+     *           can also be made for each game. A handle can only be used
+     *           by one thread at a time unless the
+     *           ::LIBLO_OPTION_THREAD_SAFE option is set.
      */
     typedef struct _lo_game_handle_int * lo_game_handle;
 
@@ -153,6 +154,92 @@ extern "C"
     LIBLO extern const unsigned int LIBLO_GAME_FO4;  /**< Game code for Fallout 4 */
 
     /**@}*/
+    /*********************//**
+     *  @name Handle Options
+     *  @brief Options that can be set for a game handle using
+     *         lo_set_handle_option().
+     ************************/
+    /**@{*/
+
+    /**
+     *  @brief Cache plugin header data on disk.
+     *  @details If set to a non-zero value, the master flag, masters and
+     *           validity of each plugin read are stored in
+     *           `libloadorder.cache` in the game's local application data
+     *           folder, and are reused for as long as the plugin's size,
+     *           modification time and file identity are unchanged. Disabled
+     *           by default.
+     */
+    LIBLO extern const unsigned int LIBLO_OPTION_HEADER_CACHE;
+
+    /**
+     *  @brief Read plugin files using multiple threads.
+     *  @details The value is the number of threads used to check the
+     *           existence and headers of plugins while loading and validating
+     *           load orders, including the calling thread. Values of 0 and 1
+     *           read plugins serially, which is the default. The maximum value
+     *           is 64.
+     */
+    LIBLO extern const unsigned int LIBLO_OPTION_WORKER_THREADS;
+
+    /**
+     *  @brief Watch plugin and load order files for changes.
+     *  @details If set to a non-zero value, the plugins folder, load order
+     *           file and active plugins file are watched for changes, and
+     *           the cached load order, active plugins and plugin data are
+     *           only reloaded after a change. Disabled by default, and only
+     *           supported on Linux: setting a non-zero value elsewhere gives
+     *           ::LIBLO_ERROR_INVALID_ARGS.
+     */
+    LIBLO extern const unsigned int LIBLO_OPTION_WATCH_CHANGES;
+
+    /**
+     *  @brief How durable saved load order and active plugins files are.
+     *  @details The files are always written to a temporary file that then
+     *           replaces the original, so they are never seen half-written.
+     *           The value is one of the Save Durability Levels, and decides
+     *           whether the write is flushed to disk before the call
+     *           returns. Defaults to ::LIBLO_DURABILITY_NONE.
+     */
+    LIBLO extern const unsigned int LIBLO_OPTION_SAVE_DURABILITY;
+
+    /**
+     *  @brief Allow the game handle to be used by multiple threads at once.
+     *  @details If set to a non-zero value, functions that only get the
+     *           load order or active plugins can run concurrently, while
+     *           functions that change them, or that reload them after they
+     *           change outside of libloadorder, run one at a time. Arrays
+     *           outputted by the handle are then kept per calling thread,
+     *           and stay valid until that thread's next call. Disabled by
+     *           default. This option must be set before the handle is
+     *           shared between threads. A transaction includes changes made
+     *           by any thread while it is open.
+     */
+    LIBLO extern const unsigned int LIBLO_OPTION_THREAD_SAFE;
+
+    /**@}*/
+    /**************************************//**
+     *  @name Save Durability Levels
+     *  @brief Values for the ::LIBLO_OPTION_SAVE_DURABILITY handle option.
+     *****************************************/
+    /**@{*/
+
+    LIBLO extern const unsigned int LIBLO_DURABILITY_NONE;  /**< Leave flushing saved files to the operating system. */
+    LIBLO extern const unsigned int LIBLO_DURABILITY_FILE;  /**< Flush each saved file's contents to disk. */
+    LIBLO extern const unsigned int LIBLO_DURABILITY_FOLDER;  /**< Flush each saved file's contents to disk, and its folder so the replacement itself survives a crash. */
+
+    /**@}*/
+    /*********************************//**
+     *  @name Plugin Enumeration Flags
+     *  @brief Flags that can be combined to filter the plugins passed to
+     *         the callback of lo_for_each_plugin().
+     ************************************/
+    /**@{*/
+
+    LIBLO extern const unsigned int LIBLO_FOR_EACH_ACTIVE_ONLY;  /**< Skip plugins that are not active. */
+    LIBLO extern const unsigned int LIBLO_FOR_EACH_MASTERS_ONLY;  /**< Skip plugins that are not master files. */
+
+    /**@}*/
 
 #ifdef __cplusplus
 }
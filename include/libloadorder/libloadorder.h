@@ -87,10 +87,12 @@ extern "C"
     /**
      *  @brief Returns the message for the last error or warning encountered.
      *  @details Outputs a string giving the a message containing the details
-     *           of the last error or warning encountered by a function. Each
-     *           time this function is called, the memory for the previous
-     *           message is freed, so only one error message is available at
-     *           any one time.
+     *           of the last error or warning encountered by a function called
+     *           on the calling thread. Each thread has its own message, which
+     *           stays valid until a function called on the same thread
+     *           encounters another error or warning, or until lo_cleanup()
+     *           is called on the same thread. Only one error message is
+     *           available per thread at any one time.
      *  @param details
      *      A pointer to the error details string outputted by the function.
      *  @returns A return code.
@@ -98,7 +100,8 @@ extern "C"
     LIBLO unsigned int lo_get_error_message(const char ** const details);
 
     /**
-     *  @brief Frees the memory allocated to the last error details string.
+     *  @brief Frees the memory allocated to the calling thread's last error
+     *         details string.
      */
     LIBLO void lo_cleanup();
 
@@ -164,6 +167,70 @@ extern "C"
     LIBLO unsigned int lo_set_game_master(lo_game_handle gh,
                                           const char * const masterFile);
 
+    /**
+     *  @brief Sets an option for a game handle.
+     *  @details Options change how libloadorder reads and writes the load
+     *           order for the given handle, but do not change the results of
+     *           any function. The available options are listed under
+     *           Handle Options in constants.h.
+     *  @param gh
+     *      The game handle to be operated on.
+     *  @param option
+     *      The code for the option to set.
+     *  @param value
+     *      The value to set the option to.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_set_handle_option(lo_game_handle gh,
+                                            const unsigned int option,
+                                            const unsigned int value);
+
+    /**@}*/
+    /******************************//**
+     *  @name Transaction Functions
+     *********************************/
+    /**@{*/
+
+    /**
+     *  @brief Begins a transaction.
+     *  @details While a transaction is open, the load order and active
+     *           plugins setter functions change the handle's cached lists
+     *           without checking their validity (see \ref valid_lo_sec and
+     *           \ref valid_apl_sec) or writing them. Both are done once when
+     *           the transaction is committed. The cached lists are not
+     *           reloaded while a transaction is open, so changes made to the
+     *           load order and active plugins by other programs are not seen
+     *           until it ends.
+     *
+     *           If a setter function fails while a transaction is open, the
+     *           changes it made are undone and the transaction stays open.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_begin_transaction(lo_game_handle gh);
+
+    /**
+     *  @brief Commits the open transaction.
+     *  @details Checks that the load order and active plugins lists are valid,
+     *           then saves them, ending the transaction. If either list is
+     *           invalid, nothing is written and the transaction stays open,
+     *           so that the lists can be corrected or the transaction aborted.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_commit_transaction(lo_game_handle gh);
+
+    /**
+     *  @brief Aborts the open transaction.
+     *  @details Discards all changes made since the transaction began.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_abort_transaction(lo_game_handle gh);
+
     /**@}*/
     /***********************//**
      *  @name Misc Functions
@@ -89,6 +89,78 @@ extern "C"
                                          char *** const plugins,
                                          size_t * const numPlugins);
 
+    /**
+     *  @brief Copy the current load order into a caller-supplied buffer.
+     *  @details Writes the current load order into the given buffer as
+     *           consecutive null-terminated plugin filenames, avoiding any
+     *           allocation by libloadorder. The size the filenames need is
+     *           always outputted, so a first call with a `NULL` buffer can
+     *           be used to size the buffer for a second call. If the buffer
+     *           is not `NULL` but is too small, nothing is written to it and
+     *           ::LIBLO_ERROR_INVALID_ARGS is returned.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @param buffer
+     *      The buffer to write the plugin filenames to, or `NULL`.
+     *  @param bufferSize
+     *      The size of the buffer in bytes.
+     *  @param requiredSize
+     *      A pointer to the outputted size in bytes that the plugin filenames
+     *      need, including their null terminators.
+     *  @param numPlugins
+     *      A pointer to the outputted number of plugins in the load order.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_copy_load_order(lo_game_handle gh,
+                                          char * const buffer,
+                                          const size_t bufferSize,
+                                          size_t * const requiredSize,
+                                          size_t * const numPlugins);
+
+    /**
+     *  @brief The type of callback passed to lo_for_each_plugin().
+     *  @param name
+     *      The plugin's filename. It is only valid until the callback returns.
+     *  @param position
+     *      The plugin's position in the load order.
+     *  @param active
+     *      Whether the plugin is active.
+     *  @param master
+     *      Whether the plugin is a master file.
+     *  @param userdata
+     *      The pointer passed to lo_for_each_plugin().
+     *  @returns `true` to continue with the next plugin, `false` to stop.
+     */
+    typedef bool (*lo_plugin_callback)(const char * name,
+                                       size_t position,
+                                       bool active,
+                                       bool master,
+                                       void * userdata);
+
+    /**
+     *  @brief Pass each plugin in the current load order to a callback.
+     *  @details Calls the given callback once for each plugin in the current
+     *           load order, in load order, without copying the plugin
+     *           filenames or allocating any arrays to output. The callback
+     *           must not call libloadorder functions with the same game
+     *           handle. As with lo_get_load_order(), the load order may be
+     *           invalid.
+     *  @param gh
+     *      The game handle the function operates on.
+     *  @param flags
+     *      Zero to pass every plugin, or a combination of the Plugin
+     *      Enumeration Flags to pass only some plugins.
+     *  @param callback
+     *      The function to call for each plugin.
+     *  @param userdata
+     *      A pointer that is passed unchanged to each call of the callback.
+     *  @returns A return code.
+     */
+    LIBLO unsigned int lo_for_each_plugin(lo_game_handle gh,
+                                          const unsigned int flags,
+                                          lo_plugin_callback callback,
+                                          void * userdata);
+
     /**
      *  @brief Set the load order.
      *  @details Sets the load order to the passed plugin array. All installed
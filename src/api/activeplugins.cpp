@@ -35,57 +35,94 @@ using namespace liblo;
    Plugin Active Status Functions
    ----------------------------------*/
 
-/* Returns the list of active plugins. */
-LIBLO unsigned int lo_get_active_plugins(lo_game_handle gh, char *** const plugins, size_t * const numPlugins) {
-    if (gh == nullptr || plugins == nullptr || numPlugins == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
-
-    unsigned int successRetCode = LIBLO_OK;
+/* Reloads the active plugins if they have changed. Returns false if they
+   couldn't be loaded, otherwise true, with the result of the validity check
+   in retCode. */
+static bool updateActivePlugins(lo_game_handle gh, unsigned int& retCode) {
+    retCode = LIBLO_OK;
+    try {
+        //Readers only need to wait for each other if there's something to reload.
+        {
+            auto lock = gh->LockShared();
+            if (!gh->activePlugins.HasChanged(*gh))
+                return true;
+        }
 
-    //Free memory if in use.
-    gh->freeStringArray();
+        auto lock = gh->LockExclusive();
 
-    //Set initial outputs.
-    *plugins = gh->extStringArray;
-    *numPlugins = gh->extStringArraySize;
+        //Plugin files may have changed since the last call.
+        gh->InvalidatePluginData();
 
-    //Update cache if necessary.
-    try {
+        //Another thread may have reloaded while this one waited for the lock.
         if (gh->activePlugins.HasChanged(*gh)) {
             gh->activePlugins.Load(*gh);
             try {
                 gh->activePlugins.CheckValidity(*gh);
             }
             catch (error& e) {
-                successRetCode = c_error(e);
+                retCode = c_error(e);
             }
         }
     }
     catch (error& e) {
-        return c_error(e);
+        retCode = c_error(e);
+        return false;
     }
+    return true;
+}
 
-    //Check array size. Exit if zero.
-    if (gh->activePlugins.empty())
-        return LIBLO_OK;
+/* Returns the list of active plugins. */
+LIBLO unsigned int lo_get_active_plugins(lo_game_handle gh, char *** const plugins, size_t * const numPlugins) {
+    if (gh == nullptr || plugins == nullptr || numPlugins == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    //Set initial outputs.
+    *plugins = nullptr;
+    *numPlugins = 0;
+
+    unsigned int successRetCode;
+    if (!updateActivePlugins(gh, successRetCode))
+        return successRetCode;
 
-    //Allocate memory.
-    gh->extStringArraySize = gh->activePlugins.Ordered().size();
+    auto lock = gh->LockShared();
+
+    //Reuse the handle's string buffer.
+    StringArrayBuffer& output = gh->OutputBuffer();
     try {
-        gh->extStringArray = new char*[gh->extStringArraySize];
-        size_t i = 0;
-        for (const auto &activePlugin : gh->activePlugins.Ordered()) {
-            gh->extStringArray[i] = ToNewCString(activePlugin.Name());
-            i++;
-        }
+        output.clear();
+        for (const auto &activePlugin : gh->activePlugins.Ordered())
+            output.push_back(activePlugin.Name());
     }
     catch (bad_alloc& e) {
+        output.clear();
         return c_error(LIBLO_ERROR_NO_MEM, e.what());
     }
 
     //Set outputs.
-    *plugins = gh->extStringArray;
-    *numPlugins = gh->extStringArraySize;
+    *plugins = output.data();
+    *numPlugins = output.size();
+
+    return successRetCode;
+}
+
+/* Copies the active plugins into a caller-supplied buffer as consecutive
+   null-terminated names, outputting the size the names need. */
+LIBLO unsigned int lo_copy_active_plugins(lo_game_handle gh, char * const buffer, const size_t bufferSize, size_t * const requiredSize, size_t * const numPlugins) {
+    if (gh == nullptr || requiredSize == nullptr || numPlugins == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    unsigned int successRetCode;
+    if (!updateActivePlugins(gh, successRetCode))
+        return successRetCode;
+
+    auto lock = gh->LockShared();
+
+    const auto& activePlugins = gh->activePlugins.Ordered();
+    *requiredSize = PackPluginNames(activePlugins, buffer, bufferSize);
+    *numPlugins = activePlugins.size();
+
+    if (buffer != nullptr && *requiredSize > bufferSize)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "The buffer is too small to hold the active plugins.");
 
     return successRetCode;
 }
@@ -93,35 +130,42 @@ LIBLO unsigned int lo_get_active_plugins(lo_game_handle gh, char *** const plugi
 /* Replaces the current list of active plugins with the given list. */
 LIBLO unsigned int lo_set_active_plugins(lo_game_handle gh, const char * const * const plugins, const size_t numPlugins) {
     if (gh == nullptr || plugins == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    gh->InvalidatePluginData();
+    gh->BeginChange();
 
     //Put input into activePlugins object.
+    gh->KeepActivePluginsForUndo();
     gh->activePlugins.clear();
     for (size_t i = 0; i < numPlugins; i++) {
         Plugin plugin(plugins[i]);
         if (gh->activePlugins.find(plugin) != gh->activePlugins.end()) {  // duplicate !
-            gh->activePlugins.clear();
-            return c_error(LIBLO_ERROR_INVALID_ARGS, "The supplied active plugins list contains duplicates.");
+            gh->RevertChange();
+            return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "The supplied active plugins list contains duplicates.");
         } else {
             //Unghost plugin if ghosted.
             try {
                 plugin.UnGhost(*gh);
             }
             catch (error& e) {
-                gh->activePlugins.clear();
+                gh->RevertChange();
                 return c_error(e);
             }
             gh->activePlugins.insert(plugin);
-            gh->activePlugins.Ordered().push_back(plugin);
         }
     }
 
-    //Check to see if basic rules are being obeyed.
+    //Check to see if basic rules are being obeyed. Within a transaction, this
+    //is done on commit.
     try {
-        gh->activePlugins.CheckValidity(*gh);
+        if (!gh->InTransaction())
+            gh->activePlugins.CheckValidity(*gh);
     }
     catch (error& e) {
-        gh->activePlugins.clear();
+        gh->RevertChange();
         return c_error(LIBLO_ERROR_INVALID_ARGS, string("Invalid active plugins list supplied. Details: ") + e.what());
     }
     // now that we know all plugins exist and are valid check if load order
@@ -129,23 +173,28 @@ LIBLO unsigned int lo_set_active_plugins(lo_game_handle gh, const char * const *
     // have made sure a load order is loaded, to avoid a reload and a save as below (at least avoid the reload)
     bool pluginsMissingLO = false;
     for (const auto& plugin : gh->activePlugins)
-        if (gh->loadOrder.getPosition(plugin.Name()) == gh->loadOrder.getLoadOrder().size()) {
+        if (!gh->loadOrder.getPlugins().contains(plugin)) {
             pluginsMissingLO = true;
             break;
         }
     // If plugins aren't in the load order, make sure they are added.
     if (pluginsMissingLO) {
-        gh->loadOrder.Load(*gh); //(ut) just Save (modified), we must at this point make sure a load order is loaded
-        gh->loadOrder.Save(*gh);
+        try {
+            gh->AddInstalledPluginsToLoadOrder();
+        }
+        catch (error& e) {
+            gh->RevertChange();
+            return c_error(e);
+        }
     }
 
     //Now save changes.
     try {
-        gh->activePlugins.Save(*gh); // for skyrim it will pop off 'Skyrim.esm' but it is and must be present in activePlugins
+        gh->SaveActivePlugins(); // for skyrim it will pop off 'Skyrim.esm' but it is and must be present in activePlugins
         return LIBLO_OK;
     }
     catch (error& e) {
-        gh->activePlugins.clear();
+        gh->RevertChange();
         return c_error(e);
     }
 }
@@ -153,7 +202,12 @@ LIBLO unsigned int lo_set_active_plugins(lo_game_handle gh, const char * const *
 /* Activates or deactivates the given plugin depending on the value of the active argument. */
 LIBLO unsigned int lo_set_plugin_active(lo_game_handle gh, const char * const plugin, const bool active) {
     if (gh == nullptr || plugin == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    gh->InvalidatePluginData();
+    gh->BeginChange();
 
     Plugin pluginObj(plugin);
 
@@ -174,17 +228,17 @@ LIBLO unsigned int lo_set_plugin_active(lo_game_handle gh, const char * const pl
     }
 
     //Look for plugin in active plugins list.
+    gh->KeepActiveStateForUndo(pluginObj);
     if (active) {  //No need to check for duplication, unordered set will silently handle avoidance.
         try {
             //Unghost plugin if ghosted.
             pluginObj.UnGhost(*gh);
             // If the plugin isn't in the load order, make sure it is added.
-            if (gh->loadOrder.getPosition(pluginObj.Name()) == gh->loadOrder.getLoadOrder().size()) {
-                gh->loadOrder.Load(*gh);
-                gh->loadOrder.Save(*gh);
-            }
+            if (!gh->loadOrder.getPlugins().contains(pluginObj))
+                gh->AddInstalledPluginsToLoadOrder();
         }
         catch (error& e) {
+            gh->RevertChange();
             return c_error(e);
         }
         // Define the plugin's load order position if it doesn't
@@ -196,21 +250,23 @@ LIBLO unsigned int lo_set_plugin_active(lo_game_handle gh, const char * const pl
             gh->activePlugins.erase(it);
     }
 
-    //Check that active plugins list is valid.
+    //Check that active plugins list is valid. Within a transaction, this is
+    //done on commit.
     try {
-        gh->activePlugins.CheckValidity(*gh);
+        if (!gh->InTransaction())
+            gh->activePlugins.CheckValidity(*gh);
     }
     catch (error& e) {
-        gh->activePlugins.clear();
+        gh->RevertChange();
         return c_error(LIBLO_ERROR_INVALID_ARGS, string("The operation results in an invalid active plugins list. Details: ") + e.what());
     }
 
     //Now save changes.
     try {
-        gh->activePlugins.Save(*gh);
+        gh->SaveActivePlugins();
     }
     catch (error& e) {
-        gh->activePlugins.clear();
+        gh->RevertChange();
         return c_error(e);
     }
 
@@ -220,28 +276,15 @@ LIBLO unsigned int lo_set_plugin_active(lo_game_handle gh, const char * const pl
 /* Checks to see if the given plugin is active. */
 LIBLO unsigned int lo_get_plugin_active(lo_game_handle gh, const char * const plugin, bool * const result) {
     if (gh == nullptr || plugin == nullptr || result == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
 
-    unsigned int successRetCode = LIBLO_OK;
+    unsigned int successRetCode;
+    if (!updateActivePlugins(gh, successRetCode))
+        return successRetCode;
 
-    Plugin pluginObj(plugin);
-
-    //Update cache if necessary.
-    try {
-        if (gh->activePlugins.HasChanged(*gh)) {
-            gh->activePlugins.Load(*gh);
-            try {
-                gh->activePlugins.CheckValidity(*gh);
-            }
-            catch (error& e) {
-                successRetCode = c_error(e);
-            }
-        }
-    }
-    catch (error& e) {
-        return c_error(e);
-    }
+    auto lock = gh->LockShared();
 
+    Plugin pluginObj(plugin);
     *result = gh->activePlugins.find(pluginObj) != gh->activePlugins.end();
 
     return successRetCode;
@@ -50,3 +50,16 @@ const unsigned int LIBLO_GAME_TES5 = 3;
 const unsigned int LIBLO_GAME_FO3 = 4;
 const unsigned int LIBLO_GAME_FNV = 5;
 const unsigned int LIBLO_GAME_FO4 = 6;
+
+const unsigned int LIBLO_OPTION_HEADER_CACHE = 0;
+const unsigned int LIBLO_OPTION_WORKER_THREADS = 1;
+const unsigned int LIBLO_OPTION_WATCH_CHANGES = 2;
+const unsigned int LIBLO_OPTION_SAVE_DURABILITY = 3;
+const unsigned int LIBLO_OPTION_THREAD_SAFE = 4;
+
+const unsigned int LIBLO_DURABILITY_NONE = 0;
+const unsigned int LIBLO_DURABILITY_FILE = 1;
+const unsigned int LIBLO_DURABILITY_FOLDER = 2;
+
+const unsigned int LIBLO_FOR_EACH_ACTIVE_ONLY = 1;
+const unsigned int LIBLO_FOR_EACH_MASTERS_ONLY = 2;
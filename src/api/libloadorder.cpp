@@ -49,7 +49,7 @@ LIBLO bool lo_is_compatible(const unsigned int versionMajor, const unsigned int
 
 LIBLO unsigned int lo_get_version(unsigned int * const versionMajor, unsigned int * const versionMinor, unsigned int * const versionPatch) {
     if (versionMajor == nullptr || versionMinor == nullptr || versionPatch == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
 
     *versionMajor = LIBLO_VERSION_MAJOR;
     *versionMinor = LIBLO_VERSION_MINOR;
@@ -63,20 +63,19 @@ LIBLO unsigned int lo_get_version(unsigned int * const versionMajor, unsigned in
    ------------------------------*/
 
 /* Outputs a string giving the a message containing the details of the
-   last error or warning encountered by a function called for the given
-   game handle. */
+   last error or warning encountered by a function called on the calling
+   thread. */
 LIBLO unsigned int lo_get_error_message(const char ** const details) {
     if (details == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
 
-    *details = extErrorString;
+    *details = LastErrorMessage();
 
     return LIBLO_OK;
 }
 
 LIBLO void lo_cleanup() {
-    delete[] extErrorString;
-    extErrorString = nullptr;
+    ClearErrorMessage();
 }
 
 /*----------------------------------
@@ -91,13 +90,18 @@ LIBLO unsigned int lo_create_handle(lo_game_handle * const gh,
                                     const char * const gamePath,
                                     const char * const localPath) {
     if (gh == nullptr || gamePath == nullptr) //Check for valid args.
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
     else if (gameId != LIBLO_GAME_TES3 && gameId != LIBLO_GAME_TES4 && gameId != LIBLO_GAME_TES5 && gameId != LIBLO_GAME_FO3 && gameId != LIBLO_GAME_FNV && gameId != LIBLO_GAME_FO4)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Invalid game specified.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Invalid game specified.");
 
-    //Set the locale to get encoding conversions working correctly.
-    std::locale::global(boost::locale::generator().generate(""));
-    boost::filesystem::path::imbue(std::locale());
+    //Set the locale to get encoding conversions working correctly. Generating
+    //it is slow, and it's process-wide, so only do it for the first handle.
+    static const bool localeSet = []() {
+        std::locale::global(boost::locale::generator().generate(""));
+        boost::filesystem::path::imbue(std::locale());
+        return true;
+    }();
+    (void)localeSet;
 
     try {
         // Check for valid paths.
@@ -113,7 +117,7 @@ LIBLO unsigned int lo_create_handle(lo_game_handle * const gh,
             (*gh)->SetLocalAppData(localPath);
 #ifndef _WIN32
         else
-            return c_error(LIBLO_ERROR_INVALID_ARGS, "A local data path must be supplied on non-Windows platforms.");
+            return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "A local data path must be supplied on non-Windows platforms.");
 #endif
     }
     catch (error& e) {
@@ -130,7 +134,7 @@ LIBLO unsigned int lo_create_handle(lo_game_handle * const gh,
         // Check for desync. This is a textfile-specific issue, but the checking
         // function will handle that distinction.
         if (!(**gh).loadOrder.isSynchronised(**gh))
-            return c_error(LIBLO_WARN_LO_MISMATCH, "The order of plugins present in both loadorder.txt and plugins.txt differs between the two files.");
+            return c_error_literal(LIBLO_WARN_LO_MISMATCH, "The order of plugins present in both loadorder.txt and plugins.txt differs between the two files.");
     }
     catch (error& e) {
         delete *gh;
@@ -155,7 +159,12 @@ LIBLO void lo_destroy_handle(lo_game_handle gh) {
    the original main master file is replaced. */
 LIBLO unsigned int lo_set_game_master(lo_game_handle gh, const char * const masterFile) {
     if (gh == nullptr || masterFile == nullptr) //Check for valid args.
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    //Plugin files may have changed since the last call.
+    gh->InvalidatePluginData();
     if (gh->LoadOrderMethod() == LIBLO_METHOD_TEXTFILE)
         return c_error(LIBLO_ERROR_INVALID_ARGS, "Cannot change main master file from " + gh->MasterFile());
 
@@ -169,6 +178,87 @@ LIBLO unsigned int lo_set_game_master(lo_game_handle gh, const char * const mast
     return LIBLO_OK;
 }
 
+/* Sets an option for the given game handle. */
+LIBLO unsigned int lo_set_handle_option(lo_game_handle gh, const unsigned int option, const unsigned int value) {
+    if (gh == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    try {
+        if (option == LIBLO_OPTION_HEADER_CACHE)
+            gh->SetHeaderCacheEnabled(value != 0);
+        else if (option == LIBLO_OPTION_WORKER_THREADS)
+            gh->SetWorkerThreads(value);
+        else if (option == LIBLO_OPTION_WATCH_CHANGES)
+            gh->SetChangeWatching(value != 0);
+        else if (option == LIBLO_OPTION_SAVE_DURABILITY)
+            gh->SetSaveDurability(value);
+        else if (option == LIBLO_OPTION_THREAD_SAFE)
+            gh->SetThreadSafe(value != 0);
+        else
+            return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Invalid option specified.");
+    }
+    catch (error& e) {
+        return c_error(e);
+    }
+
+    return LIBLO_OK;
+}
+
+/*----------------------------------
+   Transaction Functions
+   ----------------------------------*/
+
+/* Starts batching load order and active plugins changes. */
+LIBLO unsigned int lo_begin_transaction(lo_game_handle gh) {
+    if (gh == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    try {
+        gh->BeginTransaction();
+    }
+    catch (error& e) {
+        return c_error(e);
+    }
+
+    return LIBLO_OK;
+}
+
+/* Validates and saves the changes made since the transaction began. */
+LIBLO unsigned int lo_commit_transaction(lo_game_handle gh) {
+    if (gh == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    try {
+        gh->CommitTransaction();
+    }
+    catch (error& e) {
+        return c_error(e);
+    }
+
+    return LIBLO_OK;
+}
+
+/* Discards the changes made since the transaction began. */
+LIBLO unsigned int lo_abort_transaction(lo_game_handle gh) {
+    if (gh == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    if (!gh->InTransaction())
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "No transaction is open.");
+
+    gh->AbortTransaction();
+
+    return LIBLO_OK;
+}
+
 /*----------------------------------
    Misc Functions
    ----------------------------------*/
@@ -176,7 +266,14 @@ LIBLO unsigned int lo_set_game_master(lo_game_handle gh, const char * const mast
 /* Removes any plugins that are not present in the filesystem from plugins.txt (and loadorder.txt if used). */
 LIBLO unsigned int lo_fix_plugin_lists(lo_game_handle gh) {
     if (gh == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    gh->InvalidatePluginData();
+    gh->BeginChange();
+    gh->KeepLoadOrderForUndo();
+    gh->KeepActivePluginsForUndo();
 
     //Only need to update loadorder.txt if it is used.
     if (gh->LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
@@ -196,9 +293,10 @@ LIBLO unsigned int lo_fix_plugin_lists(lo_game_handle gh) {
             gh->loadOrder.partitionMasters(*gh);
 
             // Now write changes.
-            gh->loadOrder.Save(*gh);
+            gh->SaveLoadOrder();
         }
         catch (error& e) {
+            gh->RevertChange();
             return c_error(e);
         }
     }
@@ -211,12 +309,11 @@ LIBLO unsigned int lo_fix_plugin_lists(lo_game_handle gh) {
 
         if (gh->LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
             // Ensure main master file is active.
-            if (gh->activePlugins.find(Plugin(gh->MasterFile())) == gh->activePlugins.end())
-                gh->activePlugins.insert(Plugin(gh->MasterFile()));
+            gh->activePlugins.insert(Plugin(gh->MasterFile()), 0);
 
             if (gh->Id() == LIBLO_GAME_TES5) {
                 // Ensure Update.esm is active, if it is installed.
-                if (Plugin("Update.esm").IsValid(*gh) && gh->activePlugins.find(Plugin("Update.esm")) == gh->activePlugins.end())
+                if (Plugin("Update.esm").IsValid(*gh))
                     gh->activePlugins.insert(Plugin("Update.esm"));
             }
         }
@@ -245,9 +342,10 @@ LIBLO unsigned int lo_fix_plugin_lists(lo_game_handle gh) {
         }
 
         // Now write changes.
-        gh->activePlugins.Save(*gh);
+        gh->SaveActivePlugins();
     }
     catch (error& e) {
+        gh->RevertChange();
         return c_error(e);
     }
 
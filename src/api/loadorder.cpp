@@ -39,59 +39,159 @@ namespace fs = boost::filesystem;
 /* Returns which method the game uses for the load order. */
 LIBLO unsigned int lo_get_load_order_method(lo_game_handle gh, unsigned int * const method) {
     if (gh == nullptr || method == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
 
     *method = gh->LoadOrderMethod();
 
     return LIBLO_OK;
 }
 
-/* Outputs a list of the plugins installed in the data path specified when the DB was
-   created in load order, with the number of plugins given by numPlugins. */
-LIBLO unsigned int lo_get_load_order(lo_game_handle gh, char *** const plugins, size_t * const numPlugins) {
-    if (gh == nullptr || plugins == nullptr || numPlugins == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+/* Reloads the load order if it has changed. Returns false if it couldn't be
+   loaded, otherwise true, with the result of the validity check in retCode. */
+static bool updateLoadOrder(lo_game_handle gh, unsigned int& retCode) {
+    retCode = LIBLO_OK;
+    try {
+        //Readers only need to wait for each other if there's something to reload.
+        {
+            auto lock = gh->LockShared();
+            if (!gh->loadOrder.HasChanged(*gh))
+                return true;
+        }
 
-    unsigned int successRetCode = LIBLO_OK;
+        auto lock = gh->LockExclusive();
 
-    //Free memory if in use.
-    gh->freeStringArray();
+        //Plugin files may have changed since the last call.
+        gh->InvalidatePluginData();
 
-    //Update cache if necessary.
-    try {
+        //Another thread may have reloaded while this one waited for the lock.
         if (gh->loadOrder.HasChanged(*gh)) {
             gh->loadOrder.Load(*gh);
             try {
                 gh->loadOrder.CheckValidity(*gh, true);
             }
             catch (error& e) {
-                successRetCode = c_error(e);
+                retCode = c_error(e);
             }
         }
     }
     catch (error& e) {
-        return c_error(e);
+        retCode = c_error(e);
+        return false;
     }
+    return true;
+}
 
-    //Exit now if load order is empty.
-    vector<string> loadOrder(gh->loadOrder.getLoadOrder());
-    if (loadOrder.empty())
-        return LIBLO_OK;
+/* Outputs a list of the plugins installed in the data path specified when the DB was
+   created in load order, with the number of plugins given by numPlugins. */
+LIBLO unsigned int lo_get_load_order(lo_game_handle gh, char *** const plugins, size_t * const numPlugins) {
+    if (gh == nullptr || plugins == nullptr || numPlugins == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    //Set initial outputs.
+    *plugins = nullptr;
+    *numPlugins = 0;
 
-    //Allocate memory.
-    gh->extStringArraySize = loadOrder.size();
+    unsigned int successRetCode;
+    if (!updateLoadOrder(gh, successRetCode))
+        return successRetCode;
+
+    auto lock = gh->LockShared();
+
+    //Reuse the handle's string buffer.
+    StringArrayBuffer& output = gh->OutputBuffer();
     try {
-        gh->extStringArray = new char*[gh->extStringArraySize];
-        for (size_t i = 0; i < gh->extStringArraySize; i++)
-            gh->extStringArray[i] = ToNewCString(loadOrder[i]);
+        output.clear();
+        for (const auto& plugin : gh->loadOrder.getPlugins())
+            output.push_back(plugin.Name());
     }
     catch (bad_alloc& e) {
+        output.clear();
         return c_error(LIBLO_ERROR_NO_MEM, e.what());
     }
 
     //Set outputs.
-    *plugins = gh->extStringArray;
-    *numPlugins = gh->extStringArraySize;
+    *plugins = output.data();
+    *numPlugins = output.size();
+
+    return successRetCode;
+}
+
+/* Copies the load order into a caller-supplied buffer as consecutive
+   null-terminated names, outputting the size the names need. */
+LIBLO unsigned int lo_copy_load_order(lo_game_handle gh, char * const buffer, const size_t bufferSize, size_t * const requiredSize, size_t * const numPlugins) {
+    if (gh == nullptr || requiredSize == nullptr || numPlugins == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    unsigned int successRetCode;
+    if (!updateLoadOrder(gh, successRetCode))
+        return successRetCode;
+
+    auto lock = gh->LockShared();
+
+    const PluginSequence& loadOrder = gh->loadOrder.getPlugins();
+    *requiredSize = PackPluginNames(loadOrder, buffer, bufferSize);
+    *numPlugins = loadOrder.size();
+
+    if (buffer != nullptr && *requiredSize > bufferSize)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "The buffer is too small to hold the load order.");
+
+    return successRetCode;
+}
+
+/* Passes each plugin in the load order to the callback, with its position and
+   its active and master status, until the callback returns false. */
+LIBLO unsigned int lo_for_each_plugin(lo_game_handle gh, const unsigned int flags, lo_plugin_callback callback, void * userdata) {
+    if (gh == nullptr || callback == nullptr)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+    if ((flags & ~(LIBLO_FOR_EACH_ACTIVE_ONLY | LIBLO_FOR_EACH_MASTERS_ONLY)) != 0)
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Invalid enumeration flags passed.");
+
+    unsigned int successRetCode;
+    if (!updateLoadOrder(gh, successRetCode))
+        return successRetCode;
+
+    //Update the active plugins cache if necessary.
+    try {
+        bool changed;
+        {
+            auto lock = gh->LockShared();
+            changed = gh->activePlugins.HasChanged(*gh);
+        }
+
+        if (changed) {
+            auto lock = gh->LockExclusive();
+            gh->InvalidatePluginData();
+            if (gh->activePlugins.HasChanged(*gh)) {
+                gh->activePlugins.Load(*gh);
+                try {
+                    gh->activePlugins.CheckValidity(*gh);
+                }
+                catch (error& e) {
+                    if (successRetCode == LIBLO_OK)
+                        successRetCode = c_error(e);
+                }
+            }
+        }
+    }
+    catch (error& e) {
+        return c_error(e);
+    }
+
+    auto lock = gh->LockShared();
+
+    const PluginSequence& loadOrder = gh->loadOrder.getPlugins();
+    size_t position = 0;
+    for (auto it = loadOrder.begin(); it != loadOrder.end(); ++it, ++position) {
+        if ((flags & LIBLO_FOR_EACH_MASTERS_ONLY) && !it.isMaster())
+            continue;
+
+        bool active = gh->activePlugins.find(*it) != gh->activePlugins.end();
+        if ((flags & LIBLO_FOR_EACH_ACTIVE_ONLY) && !active)
+            continue;
+
+        if (!callback(it->Name().c_str(), position, active, it.isMaster(), userdata))
+            break;
+    }
 
     return successRetCode;
 }
@@ -102,34 +202,42 @@ LIBLO unsigned int lo_get_load_order(lo_game_handle gh, char *** const plugins,
    liblo and the client possibly having different definitions of what an "invalid" plugin is.*/
 LIBLO unsigned int lo_set_load_order(lo_game_handle gh, const char * const * const plugins, const size_t numPlugins) {
     if (gh == nullptr || plugins == nullptr)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Null pointer passed.");
+
+    auto lock = gh->LockExclusive();
+
+    gh->InvalidatePluginData();
+    gh->BeginChange();
     if (numPlugins == 0)
-        return c_error(LIBLO_ERROR_INVALID_ARGS, "Zero-length plugin array passed.");
+        return c_error_literal(LIBLO_ERROR_INVALID_ARGS, "Zero-length plugin array passed.");
 
     //Put input into loadOrder object.
     vector<string> loadOrder;
+    gh->KeepLoadOrderForUndo();
     gh->loadOrder.clear();
     for (size_t i = 0; i < numPlugins; i++) {
         loadOrder.push_back(plugins[i]);
     }
 
     //Check to see if basic rules are being obeyed. Also checks for plugin's existence.
+    //Within a transaction, the full check is done on commit.
     try {
         gh->loadOrder.setLoadOrder(loadOrder, *gh);
-        gh->loadOrder.CheckValidity(*gh, false);
+        if (!gh->InTransaction())
+            gh->loadOrder.CheckValidity(*gh, false);
     }
     catch (error& e) {
-        gh->loadOrder.clear();
+        gh->RevertChange();
         return c_error(LIBLO_ERROR_INVALID_ARGS, string("Invalid load order supplied. Details: ") + e.what());
     }
 
     //Now save changes.
     try {
-        gh->loadOrder.Save(*gh);
+        gh->SaveLoadOrder();
         return LIBLO_OK;
     }
     catch (error& e) {
-        gh->loadOrder.clear();
+        gh->RevertChange();
         return c_error(e);
     }
 }
@@ -0,0 +1,156 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "CaseFolding.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define LIBLO_CASEFOLD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define LIBLO_CASEFOLD_SSE2
+#endif
+
+namespace liblo {
+    namespace casefold {
+        static const uint64_t ones = 0x0101010101010101ULL;
+        static const uint64_t highBits = 0x8080808080808080ULL;
+
+        static inline uint64_t LoadWord(const char * p) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            return word;
+        }
+
+        // Loads fewer than 8 bytes, zero-padded.
+        static inline uint64_t LoadPartialWord(const char * p, size_t length) {
+            uint64_t word = 0;
+            memcpy(&word, p, length);
+            return word;
+        }
+
+        // Folds the 8 bytes of a word at once. Adding to the low 7 bits of a
+        // byte can't carry into the next, and sets its high bit once the byte
+        // reaches the added amount's complement, giving >= 'A' and > 'Z' tests.
+        // Bytes with their own high bit set are never letters.
+        static inline uint64_t FoldWord(uint64_t word) {
+            uint64_t low = word & ~highBits;
+            uint64_t atLeastA = low + (0x80 - 'A') * ones;
+            uint64_t pastZ = low + (0x80 - 'Z' - 1) * ones;
+            uint64_t upper = atLeastA & ~pastZ & ~word & highBits;
+            return word | (upper >> 2);
+        }
+
+#ifdef LIBLO_CASEFOLD_SSE2
+        static inline __m128i Fold128(__m128i v) {
+            // Signed comparisons, so bytes >= 0x80 are negative and never match.
+            __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                          _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+            return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        }
+#endif
+
+#ifdef LIBLO_CASEFOLD_AVX2
+        static inline __m256i Fold256(__m256i v) {
+            __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+            return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        }
+#endif
+
+        void Fold(const char * src, char * dst, size_t length) {
+            size_t i = 0;
+#ifdef LIBLO_CASEFOLD_AVX2
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Fold256(v));
+            }
+#endif
+#ifdef LIBLO_CASEFOLD_SSE2
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Fold128(v));
+            }
+#endif
+            for (; i + 8 <= length; i += 8) {
+                uint64_t word = FoldWord(LoadWord(src + i));
+                memcpy(dst + i, &word, sizeof(word));
+            }
+            for (; i < length; ++i)
+                dst[i] = FoldChar(src[i]);
+        }
+
+        bool Equals(const char * lhs, const char * rhs, size_t length) {
+            size_t i = 0;
+#ifdef LIBLO_CASEFOLD_AVX2
+            for (; i + 32 <= length; i += 32) {
+                __m256i l = Fold256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)));
+                __m256i r = Fold256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)) != -1)
+                    return false;
+            }
+#endif
+#ifdef LIBLO_CASEFOLD_SSE2
+            for (; i + 16 <= length; i += 16) {
+                __m128i l = Fold128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)));
+                __m128i r = Fold128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF)
+                    return false;
+            }
+#endif
+            for (; i + 8 <= length; i += 8) {
+                if (FoldWord(LoadWord(lhs + i)) != FoldWord(LoadWord(rhs + i)))
+                    return false;
+            }
+            if (i < length)
+                return FoldWord(LoadPartialWord(lhs + i, length - i)) == FoldWord(LoadPartialWord(rhs + i, length - i));
+            return true;
+        }
+
+        bool EndsWith(const char * str, size_t length, const char * suffix, size_t suffixLength) {
+            return suffixLength <= length && Equals(str + length - suffixLength, suffix, suffixLength);
+        }
+
+        // Mixes one folded word at a time, so the result doesn't depend on
+        // which of the paths above is compiled in.
+        uint64_t Hash(const char * str, size_t length) {
+            const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+            uint64_t hash = length * multiplier;
+            size_t i = 0;
+            for (; i + 8 <= length; i += 8) {
+                hash = (hash ^ FoldWord(LoadWord(str + i))) * multiplier;
+                hash ^= hash >> 29;
+            }
+            if (i < length) {
+                hash = (hash ^ FoldWord(LoadPartialWord(str + i, length - i))) * multiplier;
+                hash ^= hash >> 29;
+            }
+            hash *= 0xBF58476D1CE4E5B9ULL;
+            return hash ^ (hash >> 32);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_CASE_FOLDING_H__
+#define __LIBLO_CASE_FOLDING_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace liblo {
+    // Plugin names are compared case-insensitively, folding the ASCII letters
+    // A-Z only; every other byte, including those of multibyte characters,
+    // compares as itself. These kernels work on 16 bytes at a time with SSE2
+    // (32 with AVX2, if the compiler targets it), or 8 at a time within a
+    // 64-bit word otherwise, so that short names don't pay for a loop per byte.
+    namespace casefold {
+        inline char FoldChar(char c) {
+            return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        }
+
+        // Writes the folded bytes of src to dst, which may be the same buffer.
+        void Fold(const char * src, char * dst, size_t length);
+
+        bool Equals(const char * lhs, const char * rhs, size_t length);
+
+        bool EndsWith(const char * str, size_t length, const char * suffix, size_t suffixLength);
+
+        // Not stable across builds or platforms, so must not be persisted.
+        uint64_t Hash(const char * str, size_t length);
+    }
+}
+
+#endif
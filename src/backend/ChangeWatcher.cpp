@@ -0,0 +1,167 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "ChangeWatcher.h"
+
+#ifdef __linux__
+#   include <cerrno>
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace liblo {
+    const unsigned int ChangeWatcher::PLUGIN_DATA;
+    const unsigned int ChangeWatcher::LOAD_ORDER;
+    const unsigned int ChangeWatcher::ACTIVE_PLUGINS;
+    const unsigned int ChangeWatcher::ALL;
+
+    ChangeWatcher::ChangeWatcher() : fd(-1), unwatched(ALL), dirty(ALL) {}
+
+    ChangeWatcher::~ChangeWatcher() {
+        Stop();
+    }
+
+    bool ChangeWatcher::IsSupported() {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void ChangeWatcher::Start(const fs::path& pluginsFolder, const fs::path& loadOrderFile, const fs::path& activePluginsFile) {
+        Stop();
+
+        lock_guard<std::mutex> guard(mutex);
+
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        // Files are watched through their parent folders, as they may be
+        // replaced rather than written in place.
+        unwatched = 0;
+        AddWatch(pluginsFolder, "", PLUGIN_DATA | LOAD_ORDER);
+        if (!loadOrderFile.empty())
+            AddWatch(loadOrderFile.parent_path(), loadOrderFile.filename().string(), LOAD_ORDER);
+        AddWatch(activePluginsFile.parent_path(), activePluginsFile.filename().string(), ACTIVE_PLUGINS | LOAD_ORDER);
+#endif
+    }
+
+    void ChangeWatcher::Stop() {
+        lock_guard<std::mutex> guard(mutex);
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+        fd = -1;
+        watches.clear();
+        unwatched = ALL;
+        dirty = ALL;
+    }
+
+    bool ChangeWatcher::Covers(unsigned int caches) const {
+        lock_guard<std::mutex> guard(mutex);
+        return fd >= 0 && (unwatched & caches) == 0;
+    }
+
+    bool ChangeWatcher::IsDirty(unsigned int caches) {
+        lock_guard<std::mutex> guard(mutex);
+        ReadEvents();
+        return (dirty & caches) != 0;
+    }
+
+    void ChangeWatcher::MarkClean(unsigned int caches) {
+        lock_guard<std::mutex> guard(mutex);
+        dirty &= ~(caches & ~unwatched);
+    }
+
+    void ChangeWatcher::Acknowledge(unsigned int caches) {
+        lock_guard<std::mutex> guard(mutex);
+        ReadEvents();
+        dirty &= ~(caches & ~unwatched);
+    }
+
+    void ChangeWatcher::AddWatch(const fs::path& folder, const string& filename, unsigned int caches) {
+#ifdef __linux__
+        const uint32_t mask = IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO
+            | IN_DELETE_SELF | IN_MOVE_SELF;
+        int descriptor = inotify_add_watch(fd, folder.c_str(), mask);
+        if (descriptor < 0) {
+            // Fall back to checking timestamps for these caches.
+            unwatched |= caches;
+            return;
+        }
+
+        Watch watch;
+        watch.descriptor = descriptor;
+        watch.filename = filename;
+        watch.caches = caches;
+        watches.push_back(watch);
+#endif
+    }
+
+    void ChangeWatcher::ReadEvents() {
+#ifdef __linux__
+        if (fd < 0)
+            return;
+
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length < 0 && errno == EINTR)
+                continue;
+            if (length <= 0)
+                return;
+
+            for (char * pos = buffer; pos < buffer + length; pos += sizeof(inotify_event) + reinterpret_cast<inotify_event *>(pos)->len) {
+                const inotify_event * event = reinterpret_cast<inotify_event *>(pos);
+                if (event->mask & IN_Q_OVERFLOW) {
+                    dirty = ALL;
+                    continue;
+                }
+
+                for (const auto& watch : watches) {
+                    if (watch.descriptor != event->wd)
+                        continue;
+
+                    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                        // The folder itself has gone, so nothing in it can be
+                        // watched any longer.
+                        unwatched |= watch.caches;
+                        dirty |= watch.caches;
+                    }
+                    else if (watch.filename.empty() || (event->len > 0 && watch.filename == event->name))
+                        dirty |= watch.caches;
+                }
+            }
+        }
+#endif
+    }
+}
@@ -0,0 +1,85 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_CHANGE_WATCHER_H__
+#define __LIBLO_CHANGE_WATCHER_H__
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace liblo {
+    // Keeps a dirty flag for each of a handle's caches, set by filesystem
+    // change notifications, so that unchanged caches can be reused without
+    // checking any file timestamps. Only supported on Linux (via inotify).
+    // Safe to query from several threads at once, so readers holding a
+    // handle's shared lock can check whether a cache is stale.
+    class ChangeWatcher {
+    public:
+        // Caches that can be marked dirty. May be combined.
+        static const unsigned int PLUGIN_DATA = 1;
+        static const unsigned int LOAD_ORDER = 2;
+        static const unsigned int ACTIVE_PLUGINS = 4;
+        static const unsigned int ALL = PLUGIN_DATA | LOAD_ORDER | ACTIVE_PLUGINS;
+
+        ChangeWatcher();
+        ~ChangeWatcher();
+
+        static bool IsSupported();
+
+        // The load order file path may be empty. All caches start dirty.
+        void Start(const boost::filesystem::path& pluginsFolder,
+                   const boost::filesystem::path& loadOrderFile,
+                   const boost::filesystem::path& activePluginsFile);
+        void Stop();
+
+        bool Covers(unsigned int caches) const;  //False if any of the caches' files can't be watched.
+        bool IsDirty(unsigned int caches);  //Reads any pending notifications first.
+        void MarkClean(unsigned int caches);
+
+        // Discards pending notifications and marks the caches clean, for
+        // use after the handle has itself written the files behind them.
+        void Acknowledge(unsigned int caches);
+    private:
+        struct Watch {
+            int descriptor;
+            std::string filename;  // Empty to match every file in the folder.
+            unsigned int caches;
+        };
+
+        mutable std::mutex mutex;  // Guards everything below.
+        int fd;
+        std::vector<Watch> watches;
+        unsigned int unwatched;
+        unsigned int dirty;
+
+        void AddWatch(const boost::filesystem::path& folder, const std::string& filename, unsigned int caches);
+        void ReadEvents();
+    };
+}
+
+#endif
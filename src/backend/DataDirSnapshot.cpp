@@ -0,0 +1,164 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "libloadorder/constants.h"
+#include "DataDirSnapshot.h"
+#include "helpers.h"
+#include "error.h"
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace liblo {
+    DataDirSnapshot::DataDirSnapshot() : valid(false), folderExists(false), folderModTime(0) {}
+
+    // The plugin name an entry is found by, ie. its filename without any
+    // .ghost extension.
+    static boost::string_ref PluginName(const DataDirSnapshot::Entry& entry) {
+        boost::string_ref name(entry.filename);
+        if (entry.ghosted)
+            name.remove_suffix(6);
+        return name;
+    }
+
+    void DataDirSnapshot::Build(const fs::path& pluginsFolder) {
+        Invalidate();
+
+        boost::system::error_code ec;
+        folderExists = fs::is_directory(pluginsFolder, ec);
+        if (folderExists) {
+            folderModTime = fs::last_write_time(pluginsFolder, ec);
+            fs::directory_iterator itr;
+            if (!ec)
+                itr = fs::directory_iterator(pluginsFolder, ec);
+            for (; !ec && itr != fs::directory_iterator(); itr.increment(ec)) {
+                Entry entry;
+                entry.filename = itr->path().filename().string();
+                entry.ghosted = FoldedEndsWith(entry.filename, ".ghost");
+
+                boost::string_ref pluginName = PluginName(entry);
+                if (!FoldedEndsWith(pluginName, ".esm") && !FoldedEndsWith(pluginName, ".esp"))
+                    continue;
+
+                if (!entry.fingerprint.read(itr->path()))
+                    continue;
+
+                // An unghosted copy of a plugin takes precedence over a ghosted one.
+                uint64_t hash = FoldedHash(pluginName);
+                const Entry * existing = Find(pluginName, hash);
+                if (existing == nullptr)
+                    index.emplace(hash, entries.size());
+                else if (existing->ghosted && !entry.ghosted) {
+                    auto range = index.equal_range(hash);
+                    for (auto it = range.first; it != range.second; ++it) {
+                        if (&entries[it->second] == existing)
+                            it->second = entries.size();
+                    }
+                }
+
+                entries.push_back(entry);
+            }
+            if (ec) {
+                Invalidate();
+                throw error(LIBLO_ERROR_FILE_READ_FAIL, "\"" + pluginsFolder.string() + "\" could not be read. Details: " + ec.message());
+            }
+        }
+        valid = true;
+    }
+
+    void DataDirSnapshot::Invalidate() {
+        valid = false;
+        folderExists = false;
+        folderModTime = 0;
+        entries.clear();
+        index.clear();
+    }
+
+    bool DataDirSnapshot::IsValid() const {
+        return valid;
+    }
+
+    bool DataDirSnapshot::FolderExists() const {
+        return folderExists;
+    }
+
+    DataDirFingerprint DataDirSnapshot::Fingerprint() const {
+        DataDirFingerprint fingerprint;
+        fingerprint.folderModTime = folderModTime;
+        for (const auto& entry : entries)
+            fingerprint.files.emplace_back(entry.filename, entry.fingerprint.mtime, entry.fingerprint.size);
+
+        return fingerprint;
+    }
+
+    bool DataDirSnapshot::Matches(const DataDirFingerprint& fingerprint) const {
+        if (folderModTime != fingerprint.folderModTime || entries.size() != fingerprint.files.size())
+            return false;
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (get<0>(fingerprint.files[i]) != entries[i].filename
+                || get<1>(fingerprint.files[i]) != entries[i].fingerprint.mtime
+                || get<2>(fingerprint.files[i]) != entries[i].fingerprint.size)
+                return false;
+        }
+        return true;
+    }
+
+    const vector<DataDirSnapshot::Entry>& DataDirSnapshot::Entries() const {
+        return entries;
+    }
+
+    const DataDirSnapshot::Entry * DataDirSnapshot::Find(boost::string_ref pluginName) const {
+        return Find(pluginName, FoldedHash(pluginName));
+    }
+
+    const DataDirSnapshot::Entry * DataDirSnapshot::Find(boost::string_ref pluginName, uint64_t foldedHash) const {
+        auto range = index.equal_range(foldedHash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (FoldedEquals(PluginName(entries[it->second]), pluginName))
+                return &entries[it->second];
+        }
+        return nullptr;
+    }
+
+    void DataDirSnapshot::SetUnghosted(boost::string_ref pluginName) {
+        Entry * entry = FindMutable(pluginName);
+        if (entry == nullptr || !entry->ghosted)
+            return;
+
+        entry->filename.resize(entry->filename.length() - 6);
+        entry->ghosted = false;
+    }
+
+    void DataDirSnapshot::SetModTime(boost::string_ref pluginName, time_t modTime) {
+        Entry * entry = FindMutable(pluginName);
+        if (entry != nullptr)
+            entry->fingerprint.mtime = modTime;
+    }
+
+    DataDirSnapshot::Entry * DataDirSnapshot::FindMutable(boost::string_ref pluginName) {
+        return const_cast<Entry *>(Find(pluginName));
+    }
+}
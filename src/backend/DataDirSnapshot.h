@@ -0,0 +1,86 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_DATA_DIR_SNAPSHOT_H__
+#define __LIBLO_DATA_DIR_SNAPSHOT_H__
+
+#include "HeaderCache.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/utility/string_ref.hpp>
+
+namespace liblo {
+    // Enough of a snapshot to tell whether a timestamp-based load order
+    // could have changed.
+    struct DataDirFingerprint {
+        time_t folderModTime = 0;
+        std::vector<std::tuple<std::string, time_t, uintmax_t>> files;  // Filename, mtime and size, in listing order.
+    };
+
+    // The plugin files in a game's plugins folder, as found by a single
+    // listing of the folder. Plugins answer their filesystem queries from
+    // the snapshot until it is invalidated.
+    class DataDirSnapshot {
+    public:
+        struct Entry {
+            std::string filename;  // As found on disk, including any .ghost extension.
+            bool ghosted;
+            FileFingerprint fingerprint;
+        };
+
+        DataDirSnapshot();
+
+        void Build(const boost::filesystem::path& pluginsFolder);  // Throws if the folder exists but can't be listed.
+        void Invalidate();
+        bool IsValid() const;
+
+        bool FolderExists() const;
+        DataDirFingerprint Fingerprint() const;
+        bool Matches(const DataDirFingerprint& fingerprint) const;
+        const std::vector<Entry>& Entries() const;  // In listing order.
+        const Entry * Find(boost::string_ref pluginName) const;  // Case-insensitive, prefers unghosted files. Null if not found.
+
+        void SetUnghosted(boost::string_ref pluginName);
+        void SetModTime(boost::string_ref pluginName, time_t modTime);
+    private:
+        bool valid;
+        bool folderExists;
+        time_t folderModTime;
+        std::vector<Entry> entries;
+        std::unordered_multimap<uint64_t, size_t> index;  // Folded hash of the plugin name to entries.
+
+        const Entry * Find(boost::string_ref pluginName, uint64_t foldedHash) const;
+        Entry * FindMutable(boost::string_ref pluginName);
+    };
+}
+
+#endif
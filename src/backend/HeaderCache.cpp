@@ -0,0 +1,166 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "libloadorder/constants.h"
+#include "HeaderCache.h"
+#include "helpers.h"
+#include "error.h"
+
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#ifndef _WIN32
+#   include <sys/stat.h>
+#endif
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace liblo {
+    // Bump this whenever the cache file format changes, to discard old caches.
+    static const string cacheFileSignature = "libloadorder header cache 3";
+
+    bool FileFingerprint::read(const fs::path& file) {
+#ifdef _WIN32
+        // No inode number is exposed, so rely on size and mtime alone.
+        boost::system::error_code ec;
+        if (!fs::is_regular_file(file, ec))
+            return false;
+        size = fs::file_size(file, ec);
+        if (ec)
+            return false;
+        mtime = fs::last_write_time(file, ec);
+        inode = 0;
+        return !ec;
+#else
+        struct stat info;
+        if (stat(file.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+            return false;
+        size = info.st_size;
+        mtime = info.st_mtime;
+        inode = info.st_ino;
+        return true;
+#endif
+    }
+
+    bool FileFingerprint::operator == (const FileFingerprint& rhs) const {
+        return size == rhs.size && mtime == rhs.mtime && inode == rhs.inode;
+    }
+
+    bool FileFingerprint::operator != (const FileFingerprint& rhs) const {
+        return !(*this == rhs);
+    }
+
+    bool HeaderCache::Find(const string& pluginName, const FileFingerprint& fingerprint, PluginHeader& header) const {
+        lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(FoldCase(pluginName));
+        if (it == entries.end() || it->second.fingerprint != fingerprint)
+            return false;
+
+        header = it->second.header;
+        return true;
+    }
+
+    void HeaderCache::Insert(const string& pluginName, const FileFingerprint& fingerprint, const PluginHeader& header) {
+        lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[FoldCase(pluginName)];
+        entry.fingerprint = fingerprint;
+        entry.header = header;
+        dirty = true;
+    }
+
+    void HeaderCache::Load(const fs::path& file, unsigned int gameId) {
+        clear();
+        fs::ifstream in(file);
+        if (in.fail())
+            return;
+
+        string line;
+        if (!getline(in, line) || line != cacheFileSignature + " " + to_string(gameId))
+            return;
+
+        // Each line holds the tab-separated size, mtime, inode, validity,
+        // master flag, whether masters were read, plugin name, why the
+        // plugin is invalid and the plugin's masters.
+        vector<string> fields;
+        while (getline(in, line)) {
+            boost::split(fields, line, boost::is_any_of("\t"));
+            if (fields.size() < 8)
+                continue;
+
+            try {
+                Entry entry;
+                entry.fingerprint.size = stoull(fields[0]);
+                entry.fingerprint.mtime = static_cast<time_t>(stoll(fields[1]));
+                entry.fingerprint.inode = stoull(fields[2]);
+                entry.header.isValid = fields[3] == "1";
+                entry.header.isMaster = fields[4] == "1";
+                entry.header.hasMasters = fields[5] == "1";
+                entry.header.error = fields[7];
+                entry.header.masters.assign(next(begin(fields), 8), end(fields));
+                entries[FoldCase(fields[6])] = entry;
+            }
+            catch (std::exception& /*e*/) {
+                // Skip corrupt entries, they'll be re-read from the plugins.
+            }
+        }
+    }
+
+    void HeaderCache::Save(const fs::path& file, unsigned int gameId) {
+        if (!dirty)
+            return;
+
+        ostringstream out;
+        out << cacheFileSignature << ' ' << gameId << '\n';
+        for (const auto& entry : entries) {
+            out << entry.second.fingerprint.size << '\t'
+                << static_cast<long long>(entry.second.fingerprint.mtime) << '\t'
+                << entry.second.fingerprint.inode << '\t'
+                << entry.second.header.isValid << '\t'
+                << entry.second.header.isMaster << '\t'
+                << entry.second.header.hasMasters << '\t'
+                << entry.first << '\t'
+                << entry.second.header.error;
+            for (const auto& master : entry.second.header.masters)
+                out << '\t' << master;
+            out << '\n';
+        }
+
+        // Write a new file and swap it in, so that a failed save can't leave
+        // a truncated cache behind.
+        try {
+            bufferToFile(file, out.str(), LIBLO_DURABILITY_NONE);
+            dirty = false;
+        }
+        catch (error& /*e*/) {}
+    }
+
+    void HeaderCache::clear() {
+        entries.clear();
+        dirty = false;
+    }
+}
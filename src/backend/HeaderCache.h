@@ -0,0 +1,84 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_HEADER_CACHE_H__
+#define __LIBLO_HEADER_CACHE_H__
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace liblo {
+    // The facts about a plugin that are read from its header.
+    struct PluginHeader {
+        bool isValid = false;
+        bool isMaster = false;
+        bool hasMasters = false;  // False if only the master flag was read.
+        std::vector<std::string> masters;
+        std::string error;  // Why the file isn't a valid plugin, if it isn't. Never holds tabs or line breaks.
+    };
+
+    // Identifies a particular version of a file on disk.
+    struct FileFingerprint {
+        uintmax_t size = 0;
+        time_t mtime = 0;
+        uintmax_t inode = 0;
+
+        bool read(const boost::filesystem::path& file);  // Returns false if the path isn't a regular file or can't be stat'ed.
+
+        bool operator == (const FileFingerprint& rhs) const;
+        bool operator != (const FileFingerprint& rhs) const;
+    };
+
+    // Persistent store of plugin header facts, keyed by plugin name and
+    // validated against the plugin file's fingerprint, so that unchanged
+    // plugins don't need their headers parsed again.
+    class HeaderCache {
+    public:
+        bool Find(const std::string& pluginName, const FileFingerprint& fingerprint, PluginHeader& header) const;
+        void Insert(const std::string& pluginName, const FileFingerprint& fingerprint, const PluginHeader& header);
+
+        void Load(const boost::filesystem::path& file, unsigned int gameId);  //Silently discards unreadable or mismatched caches.
+        void Save(const boost::filesystem::path& file, unsigned int gameId);  //Only writes if the cache has changed.
+
+        void clear();
+    private:
+        struct Entry {
+            FileFingerprint fingerprint;
+            PluginHeader header;
+        };
+
+        std::unordered_map<std::string, Entry> entries;
+        bool dirty = false;
+        mutable std::mutex mutex;  //Find and Insert may be called from worker threads.
+    };
+}
+
+#endif
@@ -29,75 +29,144 @@
 #include "game.h"
 #include "helpers.h"
 
-#include <regex>
+#include <limits>
 #include <set>
 #include <unordered_map>
 
-#include <boost/algorithm/string.hpp>
-
 using namespace std;
 namespace fs = boost::filesystem;
 
 namespace liblo {
+    // Reads the plugin filenames listed in a loadorder.txt or plugins.txt,
+    // skipping blank lines and comments. Filenames in plugins.txt are
+    // encoded in Windows-1252, so they can be transcoded to UTF-8.
+    static vector<string> readPluginList(const fs::path& file, bool transcode) {
+        string contents;
+        fileToBuffer(file, contents);
+
+        vector<string> lines;
+        ForEachLine(contents, [&](boost::string_ref line) {
+            if (transcode)
+                lines.push_back(ToUTF8(line.to_string()));
+            else
+                lines.emplace_back(line.begin(), line.end());
+        });
+        return lines;
+    }
+
+    // Case-insensitive hashing and equality for names that are views into
+    // lines already read, so that no folded copies are made.
+    struct FoldedRefHash {
+        size_t operator()(boost::string_ref name) const {
+            return static_cast<size_t>(FoldedHash(name));
+        }
+    };
+
+    struct FoldedRefEqualTo {
+        bool operator()(boost::string_ref lhs, boost::string_ref rhs) const {
+            return FoldedEquals(lhs, rhs);
+        }
+    };
+
     /////////////////////////
     // LoadOrder Members
     /////////////////////////
 
-    struct PluginSortInfo {
-        PluginSortInfo() : isMasterFile(false), modTime(0) {}
-        bool isMasterFile;
-        time_t modTime;
-    };
-
     struct pluginComparator {
         const _lo_game_handle_int& parentGame;
-        std::unordered_map <std::string, PluginSortInfo> pluginCache;
 
         pluginComparator(const _lo_game_handle_int& game) : parentGame(game) {}
 
-        bool    operator () (const Plugin& plugin1, const Plugin& plugin2) {
+        bool    operator () (const Plugin& plugin1, const Plugin& plugin2) const {
             //Return true if plugin1 goes before plugin2, false otherwise.
             //Master files should go before other files.
             //Earlier stamped plugins should go before later stamped plugins.
+            //Both facts are cached in the handle's plugin metadata store.
+            bool isMaster1 = plugin1.IsMasterFileNoThrow(parentGame);
+            bool isMaster2 = plugin2.IsMasterFileNoThrow(parentGame);
 
-            auto p1It = pluginCache.find(plugin1.Name());
-            auto p2It = pluginCache.find(plugin2.Name());
+            if (isMaster1 != isMaster2)
+                return isMaster1;
 
-            // If either of the plugins haven't been cached, cache them now,
-            // but defer reading timestamps, since it's not always necessary.
-            if (p1It == pluginCache.end()) {
-                PluginSortInfo psi;
-                psi.isMasterFile = plugin1.IsMasterFileNoThrow(parentGame);
-                p1It = pluginCache.insert(std::pair<std::string, PluginSortInfo>(plugin1.Name(), psi)).first;
-            }
+            return (difftime(plugin1.GetModTime(parentGame), plugin2.GetModTime(parentGame)) < 0);
+        }
+    };
 
-            if (p2It == pluginCache.end()) {
-                PluginSortInfo psi;
-                psi.isMasterFile = plugin2.IsMasterFileNoThrow(parentGame);
-                p2It = pluginCache.insert(std::pair<std::string, PluginSortInfo>(plugin2.Name(), psi)).first;
-            }
+    // Redistributes the given timestamps so that they increase through the
+    // load order, padding them out if any are shared.
+    static vector<time_t> redistributedTimestamps(const vector<time_t>& current) {
+        std::set<time_t> timestamps(begin(current), end(current));
+        while (timestamps.size() < current.size()) {
+            timestamps.insert(*timestamps.crbegin() + 60);
+        }
+        return vector<time_t>(begin(timestamps), end(timestamps));
+    }
 
-            if (p1It->second.isMasterFile && !p2It->second.isMasterFile)
-                return true;
-            else if (!p1It->second.isMasterFile && p2It->second.isMasterFile)
-                return false;
-            else {
-                // Need to compare timestamps to decide. If either cached
-                // timestamp is zero, read and cache the actual timestamp.
-                if (p1It->second.modTime == 0) {
-                    p1It->second.modTime = plugin1.GetModTime(parentGame);
+    // Gives strictly increasing timestamps for the plugins in load order,
+    // keeping as many of their current timestamps as possible. The plugins
+    // in a longest strictly increasing run of current timestamps keep theirs,
+    // and the others are spread out between them. If there isn't room to do
+    // that, the current timestamps are redistributed instead.
+    static vector<time_t> orderedTimestamps(const vector<time_t>& current) {
+        const size_t none = numeric_limits<size_t>::max();
+        vector<size_t> tails;
+        vector<size_t> previous(current.size(), none);
+        for (size_t i = 0; i < current.size(); ++i) {
+            auto it = lower_bound(begin(tails), end(tails), current[i], [&](size_t index, time_t value) {
+                return current[index] < value;
+            });
+            if (it != begin(tails))
+                previous[i] = *prev(it);
+            if (it == end(tails))
+                tails.push_back(i);
+            else
+                *it = i;
+        }
+
+        vector<bool> kept(current.size(), false);
+        for (size_t i = tails.empty() ? none : tails.back(); i != none; i = previous[i])
+            kept[i] = true;
+
+        vector<time_t> timestamps(current);
+        size_t first = 0;
+        for (size_t i = 0; i <= current.size(); ++i) {
+            if (i < current.size() && !kept[i])
+                continue;
+
+            // Spread plugins [first, i) between the kept neighbours, or at
+            // the usual spacing if there's no neighbour on one side.
+            size_t count = i - first;
+            if (count > 0) {
+                time_t lower, upper;
+                if (first == 0) {
+                    upper = current[i];
+                    lower = max<time_t>(-1, upper - 60 * static_cast<time_t>(count + 1));
+                }
+                else if (i == current.size()) {
+                    lower = current[first - 1];
+                    upper = lower + 60 * static_cast<time_t>(count + 1);
                 }
-                if (p2It->second.modTime == 0) {
-                    p2It->second.modTime = plugin2.GetModTime(parentGame);
+                else {
+                    lower = current[first - 1];
+                    upper = current[i];
                 }
 
-                return (difftime(p1It->second.modTime, p2It->second.modTime) < 0);
+                time_t step = (upper - lower) / static_cast<time_t>(count + 1);
+                if (step < 1)
+                    return redistributedTimestamps(current);
+
+                for (size_t j = 0; j < count; ++j)
+                    timestamps[first + j] = lower + step * static_cast<time_t>(j + 1);
             }
+            first = i + 1;
         }
-    };
+        return timestamps;
+    }
 
     void LoadOrder::Load(const _lo_game_handle_int& parentGame) {
-        loadOrder.clear();
+        // Clear the flag first, so that changes made while loading aren't missed.
+        parentGame.changeWatcher.MarkClean(ChangeWatcher::LOAD_ORDER);
+        clear();
         bool createLoTxt = parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE;
         if (createLoTxt) {
             /*Game uses the new load order system.
@@ -120,11 +189,16 @@ namespace liblo {
                 loadFromFile(parentGame.ActivePluginsFile(), parentGame);
             else if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
                 //Make sure that the main master is first.
-                loadOrder.insert(begin(loadOrder), Plugin(parentGame.MasterFile()));
+                Plugin masterFile(parentGame.MasterFile());
+                masterFile.Intern(parentGame);
+                loadOrder.insert(0, masterFile, true);
                 if (parentGame.Id() == LIBLO_GAME_TES5) {
                     //Add Update.esm if not already present.
-                    if (Plugin("Update.esm").IsValid(parentGame))
-                        loadOrder.push_back(Plugin("Update.esm"));
+                    Plugin updateEsm("Update.esm");
+                    if (updateEsm.IsValid(parentGame)) {
+                        updateEsm.Intern(parentGame);
+                        loadOrder.push_back(updateEsm, updateEsm.IsMasterFileNoThrow(parentGame));
+                    }
                 }
             }
         }
@@ -142,50 +216,57 @@ namespace liblo {
         }
         //Arrange into timestamp order if required.
         if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP) {
+            Plugin::Prefetch(loadOrder.Plugins(), parentGame);
             pluginComparator pc(parentGame);
-            sort(begin(loadOrder), end(loadOrder), pc);
+            loadOrder.sort(pc);
+
+            loadedFrom = parentGame.DataDir().Fingerprint();
+            unchangedSinceLoad = true;
         }
+        // Persist any headers that had to be parsed.
+        parentGame.SaveHeaderCache();
     }
 
     void LoadOrder::Save(_lo_game_handle_int& parentGame) {
         if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP) {
             //Update timestamps.
-            //Want to make a minimum of changes to timestamps, so use the same timestamps as are currently set, but apply them to the plugins in the new order.
-            //First we have to read all the timestamps.
-            std::set<time_t> timestamps;
+            //Want to make a minimum of changes to timestamps, so only touch
+            //the plugins whose current timestamps are out of order.
+            vector<time_t> current;
             for (const auto &plugin : loadOrder) {
-                timestamps.insert(plugin.GetModTime(parentGame));
-            }
-            // It may be that two plugins currently share the same timestamp,
-            // which will result in fewer timestamps in the set than there are
-            // plugins, so pad the set if necessary.
-            while (timestamps.size() < loadOrder.size()) {
-                timestamps.insert(*timestamps.crbegin() + 60);
+                current.push_back(plugin.GetModTime(parentGame));
             }
+            vector<time_t> timestamps(orderedTimestamps(current));
+
+            vector<pair<Plugin, time_t>> changes;
             size_t i = 0;
-            for (const auto &timestamp : timestamps) {
-                loadOrder.at(i).SetModTime(parentGame, timestamp);
+            for (const auto &plugin : loadOrder) {
+                if (timestamps[i] != current[i])
+                    changes.emplace_back(plugin, timestamps[i]);
                 ++i;
             }
+            Plugin::SetModTimes(changes, parentGame);
+            // The snapshot and load order already reflect the new timestamps.
+            parentGame.changeWatcher.Acknowledge(ChangeWatcher::PLUGIN_DATA | ChangeWatcher::LOAD_ORDER);
         }
         else {
             //Need to write both loadorder.txt and plugins.txt.
             try {
                 if (!fs::exists(parentGame.LoadOrderFile().parent_path()))
                     fs::create_directory(parentGame.LoadOrderFile().parent_path());
-                fs::ofstream outfile(parentGame.LoadOrderFile(), ios_base::trunc);
-                outfile.exceptions(std::ios_base::badbit);
 
+                string contents;
                 for (const auto &plugin : loadOrder)
-                    outfile << plugin.Name() << endl;
-                outfile.close();
+                    contents += plugin.Name() + '\n';
+                bufferToFile(parentGame.LoadOrderFile(), contents, parentGame.SaveDurability());
 
                 //Now record new loadorder.txt mtime.
                 //Plugins.txt doesn't need its mtime updated as only the order of its contents has changed, and it is stored in memory as an unordered set.
                 mtime = fs::last_write_time(parentGame.LoadOrderFile());
                 mtime_data_dir = fs::last_write_time(parentGame.PluginsFolder());
+                parentGame.changeWatcher.Acknowledge(ChangeWatcher::LOAD_ORDER);
             }
-            catch (std::ios_base::failure& e) {
+            catch (fs::filesystem_error& e) {
                 throw error(LIBLO_ERROR_FILE_WRITE_FAIL, "\"" + parentGame.LoadOrderFile().string() + "\" cannot be written to. Details: " + e.what());
             }
             if (!_saveActive) return;
@@ -193,6 +274,8 @@ namespace liblo {
             if (parentGame.activePlugins.HasChanged(parentGame))
                 parentGame.activePlugins.Load(parentGame);
             parentGame.activePlugins.Save(parentGame);
+            // Writing plugins.txt also flags the load order as changed.
+            parentGame.changeWatcher.Acknowledge(ChangeWatcher::LOAD_ORDER);
         }
     }
 
@@ -207,11 +290,12 @@ namespace liblo {
         return pluginNames;
     }
 
+    const PluginSequence& LoadOrder::getPlugins() const {
+        return loadOrder;
+    }
+
     size_t LoadOrder::getPosition(const std::string& pluginName) const {
-        return distance(begin(loadOrder),
-                        find(begin(loadOrder),
-                        end(loadOrder),
-                        pluginName));
+        return loadOrder.find(pluginName);
     }
 
     std::string LoadOrder::getPluginAtPosition(size_t index) const {
@@ -219,71 +303,81 @@ namespace liblo {
     }
 
     void LoadOrder::setLoadOrder(const std::vector<std::string>& pluginNames, const _lo_game_handle_int& gameHandle) {
+        unchangedSinceLoad = false;
         // For textfile-based load order games, check that the game's master file loads first.
-        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && (pluginNames.empty() || !boost::iequals(pluginNames[0], gameHandle.MasterFile())))
+        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && (pluginNames.empty() || !FoldedEquals(pluginNames[0], gameHandle.MasterFile())))
             throw error(LIBLO_ERROR_INVALID_ARGS, "\"" + gameHandle.MasterFile() + "\" must load first.");
 
         // Create vector of Plugin objects, reusing existing objects
         // where possible. Also check for duplicate entries, that new
         // plugins are valid,
         vector<Plugin> plugins;
-        unordered_set<string> hashset;
+        unordered_set<Plugin> hashset;
         for_each(begin(pluginNames), end(pluginNames), [&](const std::string& pluginName) {
-            if (hashset.find(boost::to_lower_copy(pluginName)) != hashset.end())
+            Plugin plugin(pluginName);
+            if (hashset.count(plugin) != 0)
                 throw error(LIBLO_ERROR_INVALID_ARGS, "\"" + pluginName + "\" is a duplicate entry.");
 
-            hashset.insert(boost::to_lower_copy(pluginName));
-            plugins.push_back(getPluginObject(pluginName, gameHandle));
+            plugin = getPluginObject(pluginName, gameHandle);
+            plugin.Intern(gameHandle);
+            hashset.insert(plugin);
+            plugins.push_back(plugin);
         });
 
         // Check that all masters load before non-masters.
-        if (!is_partitioned(begin(plugins),
-            end(plugins),
-            [&](const Plugin& plugin) {
-            return plugin.IsMasterFile(gameHandle);
-        })) {
+        vector<bool> masters;
+        for (const auto& plugin : plugins)
+            masters.push_back(plugin.IsMasterFile(gameHandle));
+        if (!is_partitioned(begin(masters), end(masters), [](bool isMaster) { return isMaster; }))
             throw error(LIBLO_ERROR_INVALID_ARGS, "Master plugins must load before all non-master plugins.");
-        }
 
-        // Swap load order for the new one.
-        loadOrder.swap(plugins);
+        // Replace the load order with the new one.
+        loadOrder.clear();
+        for (size_t i = 0; i < plugins.size(); ++i)
+            loadOrder.push_back(plugins[i], masters[i]);
 
         if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
             // Make sure that game master is active.
-            loadOrder.front().activate();
+            loadOrder.at(0).activate();
         }
     }
 
    void LoadOrder::setPosition(const std::string& pluginName, size_t loadOrderIndex, const _lo_game_handle_int& gameHandle) {
+        unchangedSinceLoad = false;
         // For textfile-based load order games, check that this doesn't move the game master file from the beginning of the load order.
         if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
-            if (loadOrderIndex == 0 && !boost::iequals(pluginName, gameHandle.MasterFile()))
+            if (loadOrderIndex == 0 && !FoldedEquals(pluginName, gameHandle.MasterFile()))
                 throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot set \"" + pluginName + "\" to load first: \"" + gameHandle.MasterFile() + "\" most load first.");
-            else if (loadOrderIndex != 0 && !loadOrder.empty() && boost::iequals(pluginName, gameHandle.MasterFile()))
+            else if (loadOrderIndex != 0 && !loadOrder.empty() && FoldedEquals(pluginName, gameHandle.MasterFile()))
                 throw error(LIBLO_ERROR_INVALID_ARGS, "\"" + pluginName + "\" must load first.");
         }
 
         // If the plugin is already in the load order, use its existing
-        // object.
+        // object and its recorded master status, so that moving it doesn't
+        // need its header.
         Plugin plugin = getPluginObject(pluginName, gameHandle);
+        plugin.Intern(gameHandle);
+        size_t currentPosition = loadOrder.find(plugin);
+        bool isMaster = currentPosition != loadOrder.size() ? loadOrder.isMaster(currentPosition) : plugin.IsMasterFile(gameHandle);
 
         // Check that a master isn't being moved before a non-master or the inverse.
-        size_t masterPartitionPoint(getMasterPartitionPoint(gameHandle));
-        if (!plugin.IsMasterFile(gameHandle) && loadOrderIndex < masterPartitionPoint)
+        size_t masterPartitionPoint(getMasterPartitionPoint());
+        if (!isMaster && loadOrderIndex < masterPartitionPoint)
             throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot move a non-master plugin before master files.");
-        else if (plugin.IsMasterFile(gameHandle)
+        else if (isMaster
                  && ((loadOrderIndex > masterPartitionPoint && masterPartitionPoint != loadOrder.size())
-                 || (getPosition(pluginName) < masterPartitionPoint && loadOrderIndex == masterPartitionPoint)))
+                 || (currentPosition < masterPartitionPoint && loadOrderIndex == masterPartitionPoint)))
                  throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot move a master file after non-master plugins.");
 
         // Erase any existing entry for the plugin.
-        loadOrder.erase(remove(begin(loadOrder), end(loadOrder), pluginName), end(loadOrder));
+        for (size_t position = loadOrder.find(plugin); position != loadOrder.size(); position = loadOrder.find(plugin))
+            loadOrder.erase(position);
 
         // If the index is larger than the load order size, set it equal to the size.
         if (loadOrderIndex > loadOrder.size())
             loadOrderIndex = loadOrder.size();
 
-        loadOrder.insert(next(begin(loadOrder), loadOrderIndex), plugin);
+        loadOrder.insert(loadOrderIndex, plugin, isMaster);
     }
 
     std::unordered_set<std::string> LoadOrder::getActivePlugins() const {
@@ -298,41 +392,33 @@ namespace liblo {
     }
 
     bool LoadOrder::isActive(const std::string& pluginName) const {
-        return find_if(begin(loadOrder), end(loadOrder), [&](const Plugin& plugin) {
-            return plugin == pluginName && plugin.isActive();
-        }) != end(loadOrder);
+        size_t position = loadOrder.find(pluginName);
+        return position != loadOrder.size() && loadOrder.at(position).isActive();
     }
 
     void LoadOrder::setActivePlugins(const std::unordered_set<std::string>& pluginNames, const _lo_game_handle_int& gameHandle) {
+        unchangedSinceLoad = false;
         if (pluginNames.size() > maxActivePlugins)
             throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot activate more than " + to_string(maxActivePlugins) + " plugins.");
 
         // Check all plugins are valid.
         for_each(begin(pluginNames), end(pluginNames), [&](const std::string& pluginName) {
-            if (count(begin(loadOrder), end(loadOrder), pluginName) == 0
+            if (!loadOrder.contains(pluginName)
                 && !Plugin(pluginName).IsValid(gameHandle))
                 throw error(LIBLO_ERROR_INVALID_ARGS, "\"" + pluginName + "\" is not a valid plugin file.");
         });
 
         if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
-            // Check that the game master file is active.
-            // Need to first lowercase all plugin names for comparison.
-            unordered_set<string> lowercasedPluginNames;
-            transform(begin(pluginNames),
-                      end(pluginNames),
-                      inserter(lowercasedPluginNames, begin(lowercasedPluginNames)),
-                      [&](const std::string& pluginName) {
-                return boost::to_lower_copy(pluginName);
-            });
-
-            // Now do the check.
-            if (lowercasedPluginNames.count(boost::to_lower_copy(gameHandle.MasterFile())) == 0)
+            // Check that the game master file is active. Plugins compare
+            // case-insensitively.
+            unordered_set<Plugin> plugins(begin(pluginNames), end(pluginNames));
+            if (plugins.count(Plugin(gameHandle.MasterFile())) == 0)
                 throw error(LIBLO_ERROR_INVALID_ARGS, gameHandle.MasterFile() + " must be active.");
 
             // Also check for Skyrim if Update.esm exists.
             if (gameHandle.Id() == LIBLO_GAME_TES5
                 && Plugin("Update.esm").IsValid(gameHandle)
-                && lowercasedPluginNames.count("update.esm") == 0)
+                && plugins.count(Plugin("Update.esm")) == 0)
                 throw error(LIBLO_ERROR_INVALID_ARGS, "Update.esm must be active.");
         }
 
@@ -344,37 +430,39 @@ namespace liblo {
         // Now activate the plugins. If a plugin isn't in the load order,
         // append it.
         for_each(begin(pluginNames), end(pluginNames), [&](const std::string& pluginName) {
-            auto it = find(begin(loadOrder), end(loadOrder), pluginName);
-            if (it == end(loadOrder))
-                it = addToLoadOrder(pluginName, gameHandle);
-            it->activate();
+            size_t position = loadOrder.find(pluginName);
+            if (position == loadOrder.size())
+                position = addToLoadOrder(pluginName, gameHandle);
+            loadOrder.at(position).activate();
         });
     }
 
     void LoadOrder::activate(const std::string& pluginName, const _lo_game_handle_int& gameHandle) {
+        unchangedSinceLoad = false;
         if (countActivePlugins() >= maxActivePlugins)
             throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot activate " + pluginName + " as this would mean more than " + to_string(maxActivePlugins) + " plugins are active.");
 
-        auto it = find(begin(loadOrder), end(loadOrder), pluginName);
-        if (it == end(loadOrder)) {
+        size_t position = loadOrder.find(pluginName);
+        if (position == loadOrder.size()) {
             Plugin plugin(pluginName);
             if (!plugin.IsValid(gameHandle))
                 throw error(LIBLO_ERROR_INVALID_ARGS, "\"" + pluginName + "\" is not a valid plugin file.");
 
-            it = addToLoadOrder(pluginName, gameHandle);
+            position = addToLoadOrder(pluginName, gameHandle);
         }
-        it->activate();
+        loadOrder.at(position).activate();
     }
 
     void LoadOrder::deactivate(const std::string& pluginName, const _lo_game_handle_int& gameHandle) {
-        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && boost::iequals(pluginName, gameHandle.MasterFile()))
+        unchangedSinceLoad = false;
+        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && FoldedEquals(pluginName, gameHandle.MasterFile()))
             throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot deactivate " + gameHandle.MasterFile() + ".");
-        else if (gameHandle.Id() == LIBLO_GAME_TES5 && boost::iequals(pluginName, "Update.esm"))
+        else if (gameHandle.Id() == LIBLO_GAME_TES5 && FoldedEquals(pluginName, "Update.esm"))
             throw error(LIBLO_ERROR_INVALID_ARGS, "Cannot deactivate Update.esm.");
 
-        auto it = find(begin(loadOrder), end(loadOrder), pluginName);
-        if (it != end(loadOrder))
-            it->deactivate();
+        size_t position = loadOrder.find(pluginName);
+        if (position != loadOrder.size())
+            loadOrder.at(position).deactivate();
     }
 
    void LoadOrder::CheckValidity(const _lo_game_handle_int& parentGame, bool _skip) {
@@ -389,10 +477,11 @@ namespace liblo {
             bool wasMaster = false;
             bool wasMasterSet = false;
             unordered_set<Plugin> hashset; // check for duplicates
-            for (const auto plugin : loadOrder) {
+            Plugin::Prefetch(loadOrder.Plugins(), parentGame);
+            for (const auto& plugin : loadOrder) {
                 if (hashset.find(plugin) != hashset.end()) {
                     msg += "\"" + plugin.Name() + "\" is in the load order twice.\n";
-                    if (plugin.exists()) wasMaster = plugin.esm();
+                    if (plugin.Exists(parentGame)) wasMaster = plugin.IsMasterFileNoThrow(parentGame);
                     continue;
                 }
                 else hashset.insert(plugin);
@@ -417,9 +506,21 @@ namespace liblo {
     }
 
     bool LoadOrder::HasChanged(const _lo_game_handle_int& parentGame) const {
+        // Reloading would lose a transaction's uncommitted changes.
+        if (parentGame.InTransaction())
+            return false;
+
         if (loadOrder.empty())
             return true;
 
+        // A timestamp-based load order that's been edited may not match
+        // what loading would give, eg. if plugins were left out of it.
+        if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP && !unchangedSinceLoad)
+            return true;
+
+        if (parentGame.changeWatcher.Covers(ChangeWatcher::LOAD_ORDER))
+            return parentGame.changeWatcher.IsDirty(ChangeWatcher::LOAD_ORDER);
+
         try {
             if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE &&
                 fs::exists(parentGame.LoadOrderFile())) {
@@ -431,9 +532,11 @@ namespace liblo {
                 time_t mdata = fs::last_write_time(parentGame.PluginsFolder());
                 return (mtext != mtime) || (mdata != mtime_data_dir);
             }
+            else if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                //Checking the folder's modification time alone doesn't catch timestamp or header
+                //changes, so compare every plugin's timestamp and size.
+                return !parentGame.DataDirMatches(loadedFrom);
             else
-                //Checking parent folder modification time doesn't work consistently, and to check if
-                // the load order has changed would probably take as long as just assuming it's changed.
                 return true;
         }
         catch (fs::filesystem_error& e) {
@@ -447,93 +550,146 @@ namespace liblo {
             || !boost::filesystem::exists(gameHandle.LoadOrderFile()))
             return true;
 
-        //First get load order according to loadorder.txt.
-        LoadOrder LoadOrderFileLO;
-        LoadOrderFileLO.loadFromFile(gameHandle.LoadOrderFile(), gameHandle);
+        // Only the listed names are compared, so plugins are only read if
+        // they're listed in just one file. The lists are kept for the first
+        // load, which would read them again.
+        FileFingerprint loadOrderFingerprint, activePluginsFingerprint;
+        loadOrderFingerprint.read(gameHandle.LoadOrderFile());
+        activePluginsFingerprint.read(gameHandle.ActivePluginsFile());
+
+        vector<string> loadOrderLines(readPluginList(gameHandle.LoadOrderFile(), false));
+        vector<string> activePluginsLines(readPluginList(gameHandle.ActivePluginsFile(), true));
+
+        gameHandle.KeepPluginList(gameHandle.LoadOrderFile(), loadOrderFingerprint, loadOrderLines);
+        gameHandle.KeepPluginList(gameHandle.ActivePluginsFile(), activePluginsFingerprint, activePluginsLines);
+
+        // Compare the listed orders of the plugins in both files. As when
+        // loading, a plugin that is listed more than once takes its last
+        // position, and masters are moved before other plugins. Without
+        // reading headers, masters are told apart by their file extension.
+        // The orders match if, walking the active plugins backwards, each
+        // group's load order positions only decrease. Loading drops invalid
+        // plugins, so an active plugin that isn't in loadorder.txt is only a
+        // mismatch if it's valid.
+        struct Listing {
+            size_t position;
+            bool seen;
+        };
+        unordered_map<boost::string_ref, Listing, FoldedRefHash, FoldedRefEqualTo> loadOrderListings(loadOrderLines.size() + 2);
+        for (size_t i = 0; i < loadOrderLines.size(); ++i)
+            loadOrderListings[loadOrderLines[i]] = { i + 1, false };
+
+        // Loading either file adds the game's main master at the start and,
+        // for Skyrim, Update.esm after the other masters if it's valid and
+        // not listed.
+        const string masterFile(gameHandle.MasterFile());
+        const string updateEsm("Update.esm");
+        const bool addsUpdateEsm = gameHandle.Id() == LIBLO_GAME_TES5 && Plugin(updateEsm).IsValid(gameHandle);
+        loadOrderListings.insert({ masterFile, { 0, false } });
+        if (addsUpdateEsm)
+            loadOrderListings.insert({ updateEsm, { loadOrderLines.size() + 1, false } });
+
+        size_t previousMaster = numeric_limits<size_t>::max();
+        size_t previousNonMaster = numeric_limits<size_t>::max();
+        auto isInOrder = [&](boost::string_ref name) {
+            auto it = loadOrderListings.find(name);
+            if (it == loadOrderListings.end())
+                return !Plugin(name.to_string()).IsValid(gameHandle);
+            if (it->second.seen)
+                return true;
+            it->second.seen = true;
 
-        //Get load order from plugins.txt.
-        LoadOrder PluginsFileLO;
-        PluginsFileLO.loadFromFile(gameHandle.ActivePluginsFile(), gameHandle);
+            size_t& previous = FoldedEndsWith(name, ".esm") ? previousMaster : previousNonMaster;
+            if (it->second.position >= previous)
+                return false;
+            previous = it->second.position;
+            return true;
+        };
 
-        //Remove any plugins from LoadOrderFileLO that are not in PluginsFileLO.
-        vector<string> loadOrderFileLoadOrder = LoadOrderFileLO.getLoadOrder();
-        loadOrderFileLoadOrder.erase(remove_if(
-            begin(loadOrderFileLoadOrder),
-            end(loadOrderFileLoadOrder),
-            [&](const string& plugin) {
-            return PluginsFileLO.getPosition(plugin) == PluginsFileLO.getLoadOrder().size();
-        }),
-            end(loadOrderFileLoadOrder));
+        auto isListed = [&](const string& name) {
+            return any_of(begin(activePluginsLines), end(activePluginsLines), [&](const string& line) {
+                return FoldedEquals(line, name);
+            });
+        };
 
-        //Compare the two LoadOrder objects: they should be identical (since mtimes for each have not been touched).
-        return PluginsFileLO.getLoadOrder() == loadOrderFileLoadOrder;
+        if (addsUpdateEsm && !isListed(updateEsm) && !isInOrder(updateEsm))
+            return false;
+        for (auto it = activePluginsLines.rbegin(); it != activePluginsLines.rend(); ++it) {
+            if (!isInOrder(*it))
+                return false;
+        }
+        return isInOrder(masterFile);
     }
 
     void LoadOrder::clear() {
+        unchangedSinceLoad = false;
         loadOrder.clear();
     }
 
     void LoadOrder::unique() {
-        // Look for duplicate entries, removing all but the last. The reverse
-        // iterators make the algorithm move everything towards the end of the
-        // collection instead of towards the beginning.
-        unordered_set<string> hashset;
-        auto it = remove_if(rbegin(loadOrder), rend(loadOrder), [&](const Plugin& plugin) {
-            bool isNotUnique = hashset.find(boost::to_lower_copy(plugin.Name())) != hashset.end();
-            hashset.insert(boost::to_lower_copy(plugin.Name()));
-            return isNotUnique;
-        });
-
-        loadOrder.erase(begin(loadOrder), it.base());
+        unchangedSinceLoad = false;
+        // Look for duplicate entries, removing all but the last.
+        loadOrder.removeDuplicates();
     }
 
     void LoadOrder::partitionMasters(const _lo_game_handle_int& gameHandle) {
-        stable_partition(begin(loadOrder),
-                         end(loadOrder),
-                         [&](const Plugin& plugin) {
+        unchangedSinceLoad = false;
+        Plugin::Prefetch(loadOrder.Plugins(), gameHandle);
+        loadOrder.partitionMasters([&](const Plugin& plugin) {
             return plugin.IsMasterFileNoThrow(gameHandle);
         });
     }
 
     void LoadOrder::loadFromFile(const boost::filesystem::path& file, const _lo_game_handle_int& gameHandle) {
-        try {
-            fs::ifstream in(file);
-            in.exceptions(std::ios_base::badbit);
+        vector<string> lines;
+        if (!gameHandle.TakePluginList(file, lines))
+            lines = readPluginList(file, file == gameHandle.ActivePluginsFile());
 
-            string line;
-            bool transcode = file == gameHandle.ActivePluginsFile();
-            while (getline(in, line)) {
-                if (line.empty() || line[0] == '#')
-                    continue;
+        // A plugin that is listed more than once takes its last position, so
+        // keep the last of each plugin's lines.
+        vector<Plugin> plugins;
+        plugins.reserve(lines.size());
+        unordered_set<Plugin> seen(lines.size());
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+            Plugin plugin(*it);
+            if (seen.insert(plugin).second)
+                plugins.push_back(plugin);
+        }
+        reverse(begin(plugins), end(plugins));
 
-                if (transcode)
-                    line = ToUTF8(line);
+        // Read all the listed plugins' headers together, then drop invalid
+        // plugins and move masters before other plugins, keeping their
+        // listed order. Textfile-based games' master file always loads first.
+        Plugin::Prefetch(plugins, gameHandle);
 
-                Plugin plugin(line);
-                if (plugin.IsValid(gameHandle)) {  // FIXME(ut): this must go
-                    // Erase the entry if it already exists.
-                    auto it = find(begin(loadOrder), end(loadOrder), line);
-                    if (it != end(loadOrder))
-                        loadOrder.erase(it);
+        vector<Plugin> masters, nonMasters;
+        for (auto& plugin : plugins) {
+            plugin.Intern(gameHandle);
+            if (!plugin.IsValid(gameHandle))
+                continue;
 
-                    // Add the entry to the appropriate place in the
-                    // load order (eg. masters before plugins).
-                    it = addToLoadOrder(line, gameHandle);
-                }
-            }
-        }
-        catch (std::ifstream::failure& e) {
-            throw error(LIBLO_ERROR_FILE_READ_FAIL, "\"" + file.string() + "\" could not be read. Details: " + e.what());
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && FoldedEquals(plugin.Name(), gameHandle.MasterFile()))
+                masters.insert(masters.begin(), plugin);
+            else if (plugin.IsMasterFile(gameHandle))
+                masters.push_back(plugin);
+            else
+                nonMasters.push_back(plugin);
         }
 
+        loadOrder.clear();
+        for (const auto& plugin : masters)
+            loadOrder.push_back(plugin, true);
+        for (const auto& plugin : nonMasters)
+            loadOrder.push_back(plugin, false);
+
         if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
             // Add the game master file if it hasn't already been loaded.
-            if (count(begin(loadOrder), end(loadOrder), gameHandle.MasterFile()) == 0)
+            if (!loadOrder.contains(Plugin(gameHandle.MasterFile())))
                 addToLoadOrder(gameHandle.MasterFile(), gameHandle);
 
             // Add Update.esm if it exists and hasn't already been loaded.
             if (gameHandle.Id() == LIBLO_GAME_TES5 && Plugin("Update.esm").IsValid(gameHandle)
-                && count(begin(loadOrder), end(loadOrder), string("Update.esm")) == 0) {
+                && !loadOrder.contains(Plugin("Update.esm"))) {
                 addToLoadOrder("Update.esm", gameHandle);
             }
         }
@@ -541,52 +697,54 @@ namespace liblo {
 
     unordered_set<Plugin> LoadOrder::LoadAdditionalFiles(const _lo_game_handle_int& parentGame) {
         unordered_set<Plugin> added;
-        if (fs::is_directory(parentGame.PluginsFolder())) {
+        const DataDirSnapshot& dataDir = parentGame.DataDir();
+        if (dataDir.FolderExists()) {
             //Now scan through Data folder. Add any plugins that aren't already in loadorder
             //to loadorder, at the end. // FIXME: TIMESTAMPS METHOD !WHY AT THE END ?
-            std::vector<std::string> accumulator; // filter plugins
-            for (fs::directory_iterator itr(parentGame.PluginsFolder()); itr != fs::directory_iterator(); ++itr) {
-                string name = itr->path().filename().string();
-                if ((boost::iends_with(name, ".esm") || boost::iends_with(name, ".esp")
-                    || boost::iends_with(name, ".ghost")) && fs::is_regular_file(itr->status())) {
-                    accumulator.push_back(name);
-                }
+            //Only the unlisted plugins are sorted and have their headers read.
+            vector<const string *> accumulator;
+            for (const auto& file : dataDir.Entries()) {
+                if (!loadOrder.contains(Plugin(file.filename)))
+                    accumulator.push_back(&file.filename);
             }
             // sort ghosts after regular files
-            std::sort(accumulator.begin(), accumulator.end());
-            auto firstNonMaster = getMasterPartitionPoint(parentGame); // again parses the files !
-            for (string s : accumulator) {
-                const Plugin plugin(s);
-                std::string name = plugin.Name(); // lops ghost off
-                if (count(begin(loadOrder), end(loadOrder), plugin) != 0) continue; // for ghosts and textfile method
-                bool isMaster = false;
+            sort(begin(accumulator), end(accumulator), [](const string * lhs, const string * rhs) {
+                return *lhs < *rhs;
+            });
+
+            vector<Plugin> plugins;
+            plugins.reserve(accumulator.size());
+            for (const auto filename : accumulator) {
+                Plugin plugin(*filename);  // lops ghost off
+                if (added.insert(plugin).second) {
+                    plugin.Intern(parentGame);
+                    plugins.push_back(plugin);
+                }
+            }
+            Plugin::Prefetch(plugins, parentGame);
+
+            //Masters are added after the last master, and other plugins at the end.
+            vector<Plugin> masters, nonMasters;
+            for (const auto& plugin : plugins) {
                 try {
-                    isMaster = plugin.IsMasterFile(parentGame); // throws on "invalid" plugin
-                    //If it is a master, add it after the last master, otherwise add it at the end.
-                    if (isMaster) {
-                        loadOrder.insert(next(begin(loadOrder), firstNonMaster), plugin);
-                        ++firstNonMaster;
-                    }
-                    else {
-                        loadOrder.push_back(plugin);
-                    }
-                    added.insert(plugin);
+                    if (plugin.IsMasterFile(parentGame)) // throws on "invalid" plugin
+                        masters.push_back(plugin);
+                    else
+                        nonMasters.push_back(plugin);
                 }
                 catch (std::exception& /*e*/) {
                     // LOG ! msg += "Plugin \"" + plugin.Name() + "\" is invalid - details: " + e.what() + "\n";
+                    added.erase(plugin);
                 }
             }
+            loadOrder.insert(getMasterPartitionPoint(), masters, true);
+            loadOrder.insert(loadOrder.size(), nonMasters, false);
         }
         return added;
     }
 
-    size_t LoadOrder::getMasterPartitionPoint(const _lo_game_handle_int& gameHandle) const {
-        return distance(begin(loadOrder),
-                        partition_point(begin(loadOrder),
-                        end(loadOrder),
-                        [&](const Plugin& plugin) {
-            return plugin.IsMasterFile(gameHandle);
-        }));
+    size_t LoadOrder::getMasterPartitionPoint() const {
+        return loadOrder.masterCount();
     }
 
     size_t LoadOrder::countActivePlugins() const {
@@ -596,9 +754,9 @@ namespace liblo {
     }
 
     Plugin LoadOrder::getPluginObject(const std::string& pluginName, const _lo_game_handle_int& gameHandle) const {
-        auto it = find(begin(loadOrder), end(loadOrder), pluginName);
-        if (it != end(loadOrder))
-            return *it;
+        size_t position = loadOrder.find(pluginName);
+        if (position != loadOrder.size())
+            return loadOrder.at(position);
         else {
             Plugin plugin(pluginName);
             if (!plugin.IsValid(gameHandle))
@@ -607,18 +765,22 @@ namespace liblo {
         }
     }
 
-    std::vector<Plugin>::iterator LoadOrder::addToLoadOrder(const std::string& pluginName, const _lo_game_handle_int& gameHandle) {
-        std::vector<Plugin>::iterator it;
+    size_t LoadOrder::addToLoadOrder(const std::string& pluginName, const _lo_game_handle_int& gameHandle) {
+        size_t position;
+        bool isMaster = true;
         Plugin plugin(pluginName);
-        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && boost::iequals(pluginName, gameHandle.MasterFile()))
-            it = loadOrder.insert(begin(loadOrder), plugin);
+        plugin.Intern(gameHandle);
+        if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && FoldedEquals(pluginName, gameHandle.MasterFile()))
+            position = 0;
         else if (plugin.IsMasterFile(gameHandle))
-            it = loadOrder.insert(next(begin(loadOrder), getMasterPartitionPoint(gameHandle)), plugin);
+            position = getMasterPartitionPoint();
         else {
-            loadOrder.push_back(plugin);
-            it = prev(loadOrder.end());
+            position = loadOrder.size();
+            isMaster = false;
         }
-        return it;
+
+        loadOrder.insert(position, plugin, isMaster);
+        return position;
     }
 
     ///////////////////////////
@@ -626,37 +788,50 @@ namespace liblo {
     ///////////////////////////
 
     void ActivePlugins::Load(const _lo_game_handle_int& parentGame) {
+        parentGame.changeWatcher.MarkClean(ChangeWatcher::ACTIVE_PLUGINS);
         clear();
         if (fs::exists(parentGame.ActivePluginsFile())) {
-            string line;
-            try {
-                fs::ifstream in(parentGame.ActivePluginsFile());
-                in.exceptions(std::ios_base::badbit);
-
-                if (!(parentGame.Id() == LIBLO_GAME_TES3)) {
-                    while (getline(in, line)) {
-                        // Check if it's a valid plugin line. The stream doesn't filter out '\r' line endings, hence the check.
-                        if (line.empty() || line[0] == '#' || line[0] == '\r')
-                            continue;
-                        Plugin plug = Plugin(ToUTF8(line));
-                        activeOrdered.push_back(plug);
-                        insert(plug);
+            if (parentGame.Id() != LIBLO_GAME_TES3) {
+                vector<string> lines;
+                if (!parentGame.TakePluginList(parentGame.ActivePluginsFile(), lines))
+                    lines = readPluginList(parentGame.ActivePluginsFile(), true);
+
+                for (const auto& name : lines) {
+                    Plugin plug = Plugin(name);
+                    plug.Intern(parentGame);
+                    insert(plug);
+                }
+            }
+            else {  //Morrowind's active file list is stored in Morrowind.ini, and that has a different format from plugins.txt.
+                string contents;
+                fileToBuffer(parentGame.ActivePluginsFile(), contents);
+
+                // Active plugins are listed as GameFileN=<plugin> settings in
+                // the [Game Files] section, where N is 0 to 999. Test setups
+                // list them before any section header, so accept those too.
+                auto isGameFileKey = [](boost::string_ref key) {
+                    if (key.length() < 9 || key.length() > 11 || !FoldedEquals(key.substr(0, 8), "GameFile"))
+                        return false;
+                    return all_of(key.begin() + 8, key.end(), [](char c) { return c >= '0' && c <= '9'; });
+                };
+
+                bool inGameFiles = false;
+                ScanIni(contents, [&](const IniSetting& setting) {
+                    if (!setting.section.empty()) {
+                        if (!FoldedEquals(setting.section, "Game Files"))
+                            return !inGameFiles;  //Stop once past [Game Files].
+                        inGameFiles = true;
                     }
-                } else {   //Morrowind's active file list is stored in Morrowind.ini, and that has a different format from plugins.txt.
-                    regex reg = regex("GameFile[0-9]{1,3}=.+\\.es(m|p)", regex::ECMAScript | regex::icase);
-                    while (getline(in, line)) {
-                        if (line.empty() || !regex_match(line, reg))
-                            continue;
-                        //Now cut off everything up to and including the = sign.
-                        Plugin plug = Plugin(ToUTF8(line.substr(line.find('=') + 1)));
-                        activeOrdered.push_back(plug);
+
+                    const boost::string_ref& value = setting.value;
+                    if (isGameFileKey(setting.key) && value.length() > 4
+                        && (FoldedEndsWith(value, ".esm") || FoldedEndsWith(value, ".esp"))) {
+                        Plugin plug = Plugin(ToUTF8(value.to_string()));
+                        plug.Intern(parentGame);
                         insert(plug);
                     }
-                }
-                in.close();
-            }
-            catch (std::ios_base::failure& e) {
-                throw error(LIBLO_ERROR_FILE_READ_FAIL, "\"" + parentGame.ActivePluginsFile().string() + "\" could not be read. Details: " + e.what());
+                    return true;
+                });
             }
         }
         // Add skyrim.esm, update.esm if missing. Note that we do not check if loaded list is valid,
@@ -665,18 +840,16 @@ namespace liblo {
         if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE) {
             // Do the game's main master file first
             Plugin plug = Plugin(parentGame.MasterFile());
-            if (find(plug) == end()){
-                insert(plug);
-                activeOrdered.insert(activeOrdered.begin(), plug); // insert first
-            }
+            plug.Intern(parentGame);
+            insert(plug, 0); // insert first
             if (parentGame.Id() == LIBLO_GAME_TES5) {
                 // Do Update.esm for Skyrim
                 plug = Plugin("Update.esm");
+                plug.Intern(parentGame);
                 if (plug.IsValid(parentGame) && find(plug) == end()) { // FIXME: must resave plugins.txt
-                    insert(plug);
                     auto firstEsp = find_if(activeOrdered.begin(), activeOrdered.end(),
                         [&parentGame](const Plugin& plugin) { return !plugin.IsMasterFileNoThrow(parentGame);  });
-                        activeOrdered.insert(firstEsp, plug); // insert at last esm position
+                    insert(plug, firstEsp - activeOrdered.begin()); // insert at last esm position
                 }
             }
         }
@@ -700,21 +873,20 @@ namespace liblo {
         try {
             if (!fs::exists(parentGame.ActivePluginsFile().parent_path()))
                 fs::create_directory(parentGame.ActivePluginsFile().parent_path());
-            fs::ofstream outfile(parentGame.ActivePluginsFile(), ios_base::trunc);
-            outfile.exceptions(std::ios_base::badbit);
 
+            string contents;
             if (!settings.empty())
-                outfile << settings << endl;  //Get those Morrowind settings back in.
+                contents += settings + '\n';  //Get those Morrowind settings back in.
 
             if (parentGame.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP) {
                 //Can write the active plugins in any order.
                 size_t i = 0;
                 for (const auto &plugin : *this) {
-                    if (parentGame.Id() == LIBLO_GAME_TES3) //Need to write "GameFileN=" before plugin name, where N is an integer from 0 up.
-                        outfile << "GameFile" << i << "=";
-
                     try {
-                        outfile << FromUTF8(plugin.Name()) << endl;
+                        string name = FromUTF8(plugin.Name());
+                        if (parentGame.Id() == LIBLO_GAME_TES3) //Need to write "GameFileN=" before plugin name, where N is an integer from 0 up.
+                            contents += "GameFile" + to_string(i) + "=";
+                        contents += name + '\n';
                     }
                     catch (error& e) {
                         badFilename = e.what();
@@ -724,21 +896,22 @@ namespace liblo {
             }
             else {
                 //Need to write the active plugins in load order.
-                for (const auto &plugin : parentGame.loadOrder.getLoadOrder()) {
-                    if (find(plugin) == end() || (parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && plugin == parentGame.MasterFile()))
+                for (const auto &plugin : parentGame.loadOrder.getPlugins()) {
+                    if (find(plugin) == end() || (parentGame.LoadOrderMethod() == LIBLO_METHOD_TEXTFILE && plugin.Name() == parentGame.MasterFile()))
                         continue;
 
                     try {
-                        outfile << FromUTF8(plugin) << endl;
+                        contents += FromUTF8(plugin.Name()) + '\n';
                     }
                     catch (error& e) {
                         badFilename = e.what();
                     }
                 }
             }
-            outfile.close();
+            bufferToFile(parentGame.ActivePluginsFile(), contents, parentGame.SaveDurability());
+            parentGame.changeWatcher.Acknowledge(ChangeWatcher::ACTIVE_PLUGINS);
         }
-        catch (std::ios_base::failure& e) {
+        catch (fs::filesystem_error& e) {
             throw error(LIBLO_ERROR_FILE_WRITE_FAIL, "\"" + parentGame.ActivePluginsFile().string() + "\" could not be written. Details: " + e.what());
         }
 
@@ -749,6 +922,7 @@ namespace liblo {
     void ActivePlugins::CheckValidity(const _lo_game_handle_int& parentGame) const {
         std::string msg = "";
         // FIXME tests below most often duplicate the ones in the Load order
+        Plugin::Prefetch(vector<Plugin>(begin(), end()), parentGame);
         for (const auto& plugin : *this) {
             if (!plugin.Exists(parentGame))
                 msg += "\"" + plugin.Name() + "\" is not installed.\n";
@@ -768,9 +942,16 @@ namespace liblo {
     }
 
     bool ActivePlugins::HasChanged(const _lo_game_handle_int& parentGame) const {
+        // Reloading would lose a transaction's uncommitted changes.
+        if (parentGame.InTransaction())
+            return false;
+
         if (empty())
             return true;
 
+        if (parentGame.changeWatcher.Covers(ChangeWatcher::ACTIVE_PLUGINS))
+            return parentGame.changeWatcher.IsDirty(ChangeWatcher::ACTIVE_PLUGINS);
+
         try {
             return (fs::exists(parentGame.ActivePluginsFile())) &&
                    (fs::last_write_time(parentGame.ActivePluginsFile()) != mtime);
@@ -780,6 +961,25 @@ namespace liblo {
         }
     }
 
-    std::vector<Plugin> &ActivePlugins::Ordered() { return activeOrdered; }
+    bool ActivePlugins::insert(const Plugin& plugin) {
+        return insert(plugin, activeOrdered.size());
+    }
+
+    bool ActivePlugins::insert(const Plugin& plugin, size_t orderedIndex) {
+        if (!std::unordered_set<Plugin>::insert(plugin).second)
+            return false;
+
+        activeOrdered.insert(activeOrdered.begin() + min(orderedIndex, activeOrdered.size()), plugin);
+        return true;
+    }
+
+    ActivePlugins::iterator ActivePlugins::erase(const_iterator position) {
+        auto it = std::find(activeOrdered.begin(), activeOrdered.end(), *position);
+        if (it != activeOrdered.end())
+            activeOrdered.erase(it);
+        return std::unordered_set<Plugin>::erase(position);
+    }
+
     void ActivePlugins::clear() { std::unordered_set<Plugin>::clear(); activeOrdered.clear(); }
+    const std::vector<Plugin>& ActivePlugins::Ordered() const { return activeOrdered; }
 }
@@ -26,14 +26,15 @@
 #ifndef __LIBLO_PLUGINS_H__
 #define __LIBLO_PLUGINS_H__
 
+#include "DataDirSnapshot.h"
 #include "Plugin.h"
+#include "PluginSequence.h"
 
 #include <string>
 #include <vector>
 #include <unordered_set>
 
 #include <boost/filesystem.hpp>
-#include <boost/locale.hpp>
 
 struct _lo_game_handle_int;
 
@@ -46,6 +47,7 @@ namespace liblo {
         void Save(_lo_game_handle_int& parentGame);  //Also updates mtime and active plugins list.
 
         std::vector<std::string> getLoadOrder() const;
+        const PluginSequence& getPlugins() const;
         size_t getPosition(const std::string& pluginName) const;
         std::string getPluginAtPosition(size_t index) const;
 
@@ -61,7 +63,7 @@ namespace liblo {
 
         void CheckValidity(const _lo_game_handle_int& parentGame, bool _skip);  //Game master first, plugins all exist.
 
-        bool HasChanged(const _lo_game_handle_int& parentGame) const;  //Checks timestamp and also if LoadOrder is empty.
+        bool HasChanged(const _lo_game_handle_int& parentGame) const;  //Checks timestamp and also if LoadOrder is empty. Safe under the shared lock.
         static bool isSynchronised(const _lo_game_handle_int& gameHandle);
 
         void clear();
@@ -74,24 +76,20 @@ namespace liblo {
         time_t mtime;
         time_t mtime_data_dir;
         bool _saveActive = true;
-        std::vector<Plugin> loadOrder;
+        PluginSequence loadOrder;
+
+        // For timestamp-based games, the plugins folder the load order was
+        // loaded from. Only valid if the load order is unchanged since.
+        DataDirFingerprint loadedFrom;
+        bool unchangedSinceLoad = false;
 
         void loadFromFile(const boost::filesystem::path& file, const _lo_game_handle_int& gameHandle);
 
-        size_t getMasterPartitionPoint(const _lo_game_handle_int& gameHandle) const;
+        size_t getMasterPartitionPoint() const;
         size_t countActivePlugins() const;
         Plugin getPluginObject(const std::string& pluginName, const _lo_game_handle_int& gameHandle) const;
 
-        std::vector<Plugin>::iterator addToLoadOrder(const std::string& pluginName, const _lo_game_handle_int& gameHandle);
-    };
-}
-
-namespace std {
-    template <>
-    struct hash < liblo::Plugin > {
-        size_t operator()(const liblo::Plugin& p) const {
-            return hash<std::string>()(boost::locale::to_lower(p.Name()));
-        }
+        size_t addToLoadOrder(const std::string& pluginName, const _lo_game_handle_int& gameHandle);
     };
 }
 
@@ -103,10 +101,16 @@ namespace liblo {
 
         void CheckValidity(const _lo_game_handle_int& parentGame) const;  //not more than 255 plugins active (254 for Skyrim), plugins all exist.
 
-        bool HasChanged(const _lo_game_handle_int& parentGame) const;
+        bool HasChanged(const _lo_game_handle_int& parentGame) const;  //Safe under the shared lock.
 
-        std::vector<Plugin> &Ordered();
+        // These hide the set's own members, so that the ordered list is kept
+        // in step with the set.
+        bool insert(const Plugin& plugin);  //Newly active plugins go at the end of the ordered list.
+        bool insert(const Plugin& plugin, size_t orderedIndex);
+        iterator erase(const_iterator position);
         void clear();
+
+        const std::vector<Plugin>& Ordered() const;  //In the order the plugins were listed or activated.
     private:
         time_t mtime;
         std::vector<Plugin> activeOrdered;
@@ -27,33 +27,56 @@
 #include "libloadorder/constants.h"
 #include "error.h"
 #include "game.h"
+#include "helpers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
 
 #include <boost/filesystem.hpp>
-#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <libespm/Plugin.h>
+
+#ifndef _WIN32
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
 
 using namespace std;
 namespace fs = boost::filesystem;
 
 namespace liblo {
-    Plugin::Plugin() : active(false) {}
+    Plugin::Plugin() : hash(FoldedHash("")), active(false), metadataStore(0), metadataId(0) {}
 
-    Plugin::Plugin(const string& filename) : name(filename), active(false) {
+    Plugin::Plugin(const string& filename) : name(filename), active(false), metadataStore(0), metadataId(0) {
         if (!name.empty() && name[name.length() - 1] == '\r')
             name = name.substr(0, name.length() - 1);
-        if (boost::iends_with(name, ".ghost"))
+        if (FoldedEndsWith(name, ".ghost"))
             name = fs::path(name).stem().string();
+        hash = FoldedHash(name);
     };
 
-    string Plugin::Name() const {
+    const string& Plugin::Name() const {
         return name;
     }
 
+    uint64_t Plugin::Hash() const {
+        return hash;
+    }
+
+    void Plugin::Intern(const _lo_game_handle_int& parentGame) const {
+        Metadata(parentGame);
+    }
+
     bool Plugin::IsValid(const _lo_game_handle_int& parentGame) const {
         // Rather than just checking the extension, try also parsing the file, and see if it fails.
-        if (!boost::iends_with(name, ".esm") && !boost::iends_with(name, ".esp"))
+        if (!FoldedEndsWith(name, ".esm") && !FoldedEndsWith(name, ".esp"))
             return false;
         try {
-            libespm::Plugin plugin = ReadHeader(parentGame);
+            ReadHeader(parentGame, false);
         }
         catch (std::exception& /*e*/) {
             return false;
@@ -62,28 +85,17 @@ namespace liblo {
     }
 
     bool Plugin::IsMasterFile(const _lo_game_handle_int& parentGame) const {
-        // TODO(ut): cache ! Plugins.mtimes map<Plugin.name, pair<mod_time, Plugin>> and Plugin.isEsm
-        if (!boost::iends_with(name, ".esm") && !boost::iends_with(name, ".esp"))
+        if (!FoldedEndsWith(name, ".esm") && !FoldedEndsWith(name, ".esp"))
             throw std::invalid_argument("Invalid file extension: " + name);
-        try {
-            libespm::Plugin plugin = ReadHeader(parentGame);
-            bool ret = plugin.isMasterFile();
-            isEsm = ret;
-            return ret;
-        }
-        catch (std::exception& e) {
-            throw e;
-        }
+
+        return ReadHeader(parentGame, false).isMaster;
     }
 
     bool Plugin::IsMasterFileNoThrow(const _lo_game_handle_int& parentGame) const {
-        if (!boost::iends_with(name, ".esm") && !boost::iends_with(name, ".esp"))
+        if (!FoldedEndsWith(name, ".esm") && !FoldedEndsWith(name, ".esp"))
             return false;
         try {
-            libespm::Plugin plugin = ReadHeader(parentGame);
-            bool ret = plugin.isMasterFile();
-            isEsm = ret;
-            return ret;
+            return ReadHeader(parentGame, false).isMaster;
         }
         catch (std::exception& /*e*/) {
             // TODO(ut): log it !
@@ -92,34 +104,25 @@ namespace liblo {
     }
 
     bool Plugin::IsGhosted(const _lo_game_handle_int& parentGame) const {
-        bool isGhost = !fs::exists(parentGame.PluginsFolder() / name) &&
-            fs::exists(parentGame.PluginsFolder() / fs::path(name + ".ghost"));
-        return isGhost;
+        auto file = parentGame.DataDir().Find(name);
+        return file != nullptr && file->ghosted;
     }
 
     bool Plugin::Exists(const _lo_game_handle_int& parentGame) const {
-        exist = fs::exists(parentGame.PluginsFolder() / name) ||
-            fs::exists(parentGame.PluginsFolder() / fs::path(name + ".ghost"));
-        return exist;
+        return parentGame.DataDir().Find(name) != nullptr;
     }
 
     time_t Plugin::GetModTime(const _lo_game_handle_int& parentGame) const {
-        try {
-            if (IsGhosted(parentGame))
-                return fs::last_write_time(parentGame.PluginsFolder() / fs::path(name + ".ghost"));
-            else
-                return fs::last_write_time(parentGame.PluginsFolder() / name);
-        }
-        catch (fs::filesystem_error& e) {
-            throw error(LIBLO_ERROR_TIMESTAMP_READ_FAIL, e.what());
-        }
+        auto file = parentGame.DataDir().Find(name);
+        if (file == nullptr)
+            throw error(LIBLO_ERROR_TIMESTAMP_READ_FAIL, "\"" + name + "\" is not installed.");
+
+        return file->fingerprint.mtime;
     }
 
     std::vector<Plugin> Plugin::GetMasters(const _lo_game_handle_int& parentGame) const {
-        libespm::Plugin plugin = ReadHeader(parentGame);
-
         vector<Plugin> masters;
-        for (const auto &master : plugin.getMasters()) {
+        for (const auto &master : ReadHeader(parentGame, true).masters) {
             masters.push_back(Plugin(master));
         }
 
@@ -127,26 +130,21 @@ namespace liblo {
     }
 
     void Plugin::UnGhost(const _lo_game_handle_int& parentGame) const {
-        if (IsGhosted(parentGame)) {
+        auto file = parentGame.DataDir().Find(name);
+        if (file != nullptr && file->ghosted) {
+            fs::path ghostPath = parentGame.PluginsFolder() / file->filename;
             try {
-                fs::rename(parentGame.PluginsFolder() / fs::path(name + ".ghost"), parentGame.PluginsFolder() / name);
+                fs::rename(ghostPath, ghostPath.parent_path() / ghostPath.stem());
             }
             catch (fs::filesystem_error& e) {
                 throw error(LIBLO_ERROR_FILE_RENAME_FAIL, e.what());
             }
+            parentGame.DataDir().SetUnghosted(name);
         }
     }
 
     void Plugin::SetModTime(const _lo_game_handle_int& parentGame, const time_t modificationTime) const {
-        try {
-            if (IsGhosted(parentGame))
-                fs::last_write_time(parentGame.PluginsFolder() / fs::path(name + ".ghost"), modificationTime);
-            else
-                fs::last_write_time(parentGame.PluginsFolder() / name, modificationTime);
-        }
-        catch (fs::filesystem_error& e) {
-            throw error(LIBLO_ERROR_TIMESTAMP_WRITE_FAIL, e.what());
-        }
+        SetModTimes({ make_pair(*this, modificationTime) }, parentGame);
     }
 
     bool Plugin::isActive() const {
@@ -162,34 +160,223 @@ namespace liblo {
     }
 
     bool Plugin::operator == (const Plugin& rhs) const {
-        return boost::iequals(name, rhs.Name());
+        if (hash != rhs.hash)
+            return false;
+        if (metadataStore != 0 && metadataStore == rhs.metadataStore)
+            return metadataId == rhs.metadataId;
+        return FoldedEquals(name, rhs.name);
     }
 
     bool Plugin::operator != (const Plugin& rhs) const {
         return !(*this == rhs);
     }
 
-    libespm::Plugin Plugin::ReadHeader(const _lo_game_handle_int& parentGame) const {
-        if (!Exists(parentGame))
+    void Plugin::SetModTimes(const vector<pair<Plugin, time_t>>& modTimes, const _lo_game_handle_int& parentGame) {
+        if (modTimes.empty())
+            return;
+
+        DataDirSnapshot& dataDir = parentGame.DataDir();
+#ifdef _WIN32
+        for (const auto& modTime : modTimes) {
+            auto file = dataDir.Find(modTime.first.Name());
+            try {
+                fs::last_write_time(parentGame.PluginsFolder() / (file == nullptr ? modTime.first.Name() : file->filename), modTime.second);
+            }
+            catch (fs::filesystem_error& e) {
+                throw error(LIBLO_ERROR_TIMESTAMP_WRITE_FAIL, e.what());
+            }
+            dataDir.SetModTime(modTime.first.Name(), modTime.second);
+        }
+#else
+        int folderFd = open(parentGame.PluginsFolder().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (folderFd == -1)
+            throw error(LIBLO_ERROR_TIMESTAMP_WRITE_FAIL, "\"" + parentGame.PluginsFolder().string() + "\" could not be opened. Details: " + strerror(errno));
+
+        for (const auto& modTime : modTimes) {
+            auto file = dataDir.Find(modTime.first.Name());
+            const string& filename = file == nullptr ? modTime.first.Name() : file->filename;
+
+            // Leave the access time alone.
+            struct timespec times[2];
+            times[0].tv_sec = 0;
+            times[0].tv_nsec = UTIME_OMIT;
+            times[1].tv_sec = modTime.second;
+            times[1].tv_nsec = 0;
+            if (utimensat(folderFd, filename.c_str(), times, 0) != 0) {
+                string details = strerror(errno);
+                close(folderFd);
+                throw error(LIBLO_ERROR_TIMESTAMP_WRITE_FAIL, "The modification time of \"" + filename + "\" could not be set. Details: " + details);
+            }
+            dataDir.SetModTime(modTime.first.Name(), modTime.second);
+        }
+        close(folderFd);
+#endif
+    }
+
+    void Plugin::Prefetch(const vector<Plugin>& plugins, const _lo_game_handle_int& parentGame) {
+        if (parentGame.workerPool.Concurrency() < 2)
+            return;
+
+        // Existence, ghost state and timestamps come from the plugins folder
+        // snapshot, so only headers need reading.
+        parentGame.DataDir();
+
+        // Resolve store entries up front, as that modifies the store. Each
+        // task then only writes to its own entry.
+        vector<const Plugin *> unique;
+        unordered_set<size_t> seen;
+        for (const auto& plugin : plugins) {
+            plugin.Metadata(parentGame);
+            if (seen.insert(plugin.metadataId).second)
+                unique.push_back(&plugin);
+        }
+
+        parentGame.workerPool.ParallelFor(unique.size(), [&](size_t i) {
+            // Anything that throws is left unread, so that it throws again
+            // when the sequential code asks for it.
+            const Plugin& plugin = *unique[i];
+            try {
+                if (plugin.Exists(parentGame))
+                    plugin.IsValid(parentGame);
+            }
+            catch (...) {}
+        });
+    }
+
+    PluginMetadata& Plugin::Metadata(const _lo_game_handle_int& parentGame) const {
+        if (metadataStore != parentGame.pluginMetadata.Serial()) {
+            metadataId = parentGame.pluginMetadata.getId(name, hash);
+            metadataStore = parentGame.pluginMetadata.Serial();
+        }
+        return parentGame.pluginMetadata.get(metadataId);
+    }
+
+    const PluginHeader& Plugin::ReadHeader(const _lo_game_handle_int& parentGame, bool withMasters) const {
+        PluginMetadata& metadata = Metadata(parentGame);
+        if (!metadata.headerRead || (withMasters && metadata.headerErrorCode == LIBLO_OK && !metadata.header.hasMasters)) {
+            try {
+                metadata.header = LoadHeader(parentGame, withMasters);
+                metadata.headerErrorCode = LIBLO_OK;
+            }
+            catch (error& e) {
+                metadata.headerErrorCode = e.code();
+                metadata.headerError = e.what();
+            }
+            metadata.headerRead = true;
+        }
+
+        if (metadata.headerErrorCode != LIBLO_OK)
+            throw error(metadata.headerErrorCode, metadata.headerError);
+
+        return metadata.header;
+    }
+
+    PluginHeader Plugin::LoadHeader(const _lo_game_handle_int& parentGame, bool withMasters) const {
+        auto file = parentGame.DataDir().Find(name);
+        if (file == nullptr)
             throw error(LIBLO_ERROR_FILE_NOT_FOUND, name.c_str());
 
-        try {
-            string filepath = (parentGame.PluginsFolder() / name).string();
-            if (IsGhosted(parentGame))
-                filepath += ".ghost";
+        string filepath = (parentGame.PluginsFolder() / file->filename).string();
 
-            libespm::Plugin plugin(parentGame.getLibespmId());
-            plugin.load(filepath, true);
+        // Only read the header if the plugin has changed since it was cached.
+        PluginHeader header;
+        const FileFingerprint& fingerprint = file->fingerprint;
+        bool useCache = parentGame.UsesHeaderCache();
+        if (useCache && parentGame.headerCache.Find(name, fingerprint, header) && (header.hasMasters || !withMasters || !header.isValid)) {
+            if (!header.isValid)
+                throw error(LIBLO_ERROR_FILE_READ_FAIL, name + " : " + header.error);
+            return header;
+        }
 
-            return plugin;
+        // Only libespm can read the masters, but the master flag and validity
+        // can be had much more cheaply from the first few bytes of the file.
+        try {
+            if (withMasters) {
+                libespm::Plugin plugin(parentGame.getLibespmId());
+                plugin.load(filepath, true);
+
+                header.isValid = true;
+                header.isMaster = plugin.isMasterFile();
+                header.masters = plugin.getMasters();
+                header.hasMasters = true;
+            }
+            else
+                header = ProbeHeader(filepath, parentGame.Id());
         }
         catch (std::exception& e) {
-            if (!Exists(parentGame))
-                throw error(LIBLO_ERROR_FILE_NOT_FOUND, name.c_str());
-            throw error(LIBLO_ERROR_FILE_READ_FAIL, name + " : " + e.what());
+            // The reason is cached too, so that later runs report the same
+            // error. It's kept on one line to fit in the cache file.
+            header = PluginHeader();
+            header.error = e.what();
+            replace_if(begin(header.error), end(header.error), [](char c) {
+                return c == '\t' || c == '\r' || c == '\n';
+            }, ' ');
+            if (useCache)
+                parentGame.headerCache.Insert(name, fingerprint, header);
+            throw error(LIBLO_ERROR_FILE_READ_FAIL, name + " : " + header.error);
         }
+
+        if (useCache)
+            parentGame.headerCache.Insert(name, fingerprint, header);
+
+        return header;
     }
 
-    bool Plugin::esm() const { return isEsm; }
-    bool Plugin::exists() const { return exist; }
+    PluginHeader Plugin::ProbeHeader(const std::string& filepath, unsigned int gameId) {
+        // All games start plugins with a header record: Morrowind's has an
+        // extra field before its flags, and Oblivion's lacks the trailing
+        // 4 bytes of later games' record headers.
+        const char * recordType = "TES4";
+        size_t headerSize = 24;
+        size_t flagsOffset = 8;
+        if (gameId == LIBLO_GAME_TES3) {
+            recordType = "TES3";
+            headerSize = 16;
+            flagsOffset = 12;
+        }
+        else if (gameId == LIBLO_GAME_TES4)
+            headerSize = 20;
+
+        unsigned char buffer[24];
+        uintmax_t fileSize = 0;
+        size_t bytesRead = 0;
+#ifdef _WIN32
+        fs::ifstream in(fs::path(filepath), ios::binary);
+        if (!in.good())
+            throw std::runtime_error("could not open file");
+        in.read(reinterpret_cast<char*>(buffer), headerSize);
+        bytesRead = static_cast<size_t>(in.gcount());
+        fileSize = fs::file_size(filepath);
+#else
+        int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error(strerror(errno));
+        struct stat info;
+        ssize_t result = fstat(fd, &info) == 0 ? pread(fd, buffer, headerSize, 0) : -1;
+        int readError = errno;
+        close(fd);
+        if (result < 0)
+            throw std::runtime_error(strerror(readError));
+        bytesRead = static_cast<size_t>(result);
+        fileSize = info.st_size;
+#endif
+
+        if (bytesRead < headerSize || memcmp(buffer, recordType, 4) != 0)
+            throw std::runtime_error("the file does not start with a " + string(recordType) + " record");
+
+        auto readUInt32 = [&](size_t offset) {
+            return uint32_t(buffer[offset])
+                | uint32_t(buffer[offset + 1]) << 8
+                | uint32_t(buffer[offset + 2]) << 16
+                | uint32_t(buffer[offset + 3]) << 24;
+        };
+
+        if (headerSize + readUInt32(4) > fileSize)
+            throw std::runtime_error("the " + string(recordType) + " record is truncated");
+
+        PluginHeader header;
+        header.isValid = true;
+        header.isMaster = (readUInt32(flagsOffset) & 0x1) != 0;
+        return header;
+    }
 }
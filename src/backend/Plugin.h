@@ -26,10 +26,12 @@
 #ifndef LIBLO_PLUGIN_H
 #define LIBLO_PLUGIN_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
-#include <libespm/Plugin.h>
+#include "HeaderCache.h"
+#include "PluginMetadataStore.h"
 
 struct _lo_game_handle_int;
 
@@ -39,7 +41,10 @@ namespace liblo {
         Plugin();
         Plugin(const std::string& filename);  //Automatically trims .ghost extension.
 
-        std::string Name() const;
+        const std::string& Name() const;
+        uint64_t Hash() const;  //Case-insensitive.
+
+        void Intern(const _lo_game_handle_int& parentGame) const;  //Lets plugins interned with the same handle compare by ID.
 
         bool    IsValid(const _lo_game_handle_int& parentGame) const;  // Attempts to parse the plugin header.
         bool    IsMasterFile(const _lo_game_handle_int& parentGame) const; // Checks master flag bit, throws on invalid file
@@ -59,15 +64,37 @@ namespace liblo {
 
         bool operator == (const Plugin& rhs) const;
         bool operator != (const Plugin& rhs) const;
-        bool esm() const;
-        bool exists() const;
+
+        // Reads the header of each plugin using the handle's worker threads,
+        // so that later queries are answered from the metadata store.
+        static void Prefetch(const std::vector<Plugin>& plugins, const _lo_game_handle_int& parentGame);
+
+        // Sets the modification times of several plugins, opening the plugins
+        // folder once rather than resolving its path for each file.
+        static void SetModTimes(const std::vector<std::pair<Plugin, time_t>>& modTimes, const _lo_game_handle_int& parentGame);
     private:
         std::string name;
-        mutable bool isEsm = false;
-        mutable bool exist = false;
+        uint64_t hash;
         bool active;
 
-        libespm::Plugin ReadHeader(const _lo_game_handle_int& parentGame) const;
+        // Identifies this plugin's interned entry in a handle's metadata store.
+        mutable uint64_t metadataStore;
+        mutable size_t metadataId;
+
+        PluginMetadata& Metadata(const _lo_game_handle_int& parentGame) const;
+        const PluginHeader& ReadHeader(const _lo_game_handle_int& parentGame, bool withMasters) const;  //Throws if the header can't be read.
+        PluginHeader LoadHeader(const _lo_game_handle_int& parentGame, bool withMasters) const;
+
+        static PluginHeader ProbeHeader(const std::string& filepath, unsigned int gameId);  //Reads only the validity and master flag.
+    };
+}
+
+namespace std {
+    template <>
+    struct hash < liblo::Plugin > {
+        size_t operator()(const liblo::Plugin& p) const {
+            return static_cast<size_t>(p.Hash());
+        }
     };
 }
 
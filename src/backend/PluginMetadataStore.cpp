@@ -0,0 +1,78 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "PluginMetadataStore.h"
+#include "helpers.h"
+#include "libloadorder/constants.h"
+
+#include <atomic>
+
+using namespace std;
+
+namespace liblo {
+    PluginMetadata::PluginMetadata(const string& pluginName, uint64_t foldedHash) :
+        name(pluginName),
+        folded(FoldCase(pluginName)),
+        hash(foldedHash) {
+        reset();
+    }
+
+    void PluginMetadata::reset() {
+        headerRead = false;
+        headerErrorCode = LIBLO_OK;
+        headerError.clear();
+        header = PluginHeader();
+    }
+
+    PluginMetadataStore::PluginMetadataStore() {
+        static atomic<uint64_t> storeCount(0);
+        serial = ++storeCount;
+    }
+
+    uint64_t PluginMetadataStore::Serial() const {
+        return serial;
+    }
+
+    size_t PluginMetadataStore::getId(const string& pluginName, uint64_t foldedHash) {
+        auto range = ids.equal_range(foldedHash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (FoldedEquals(entries[it->second].name, pluginName))
+                return it->second;
+        }
+
+        ids.emplace(foldedHash, entries.size());
+        entries.emplace_back(pluginName, foldedHash);
+        return entries.size() - 1;
+    }
+
+    PluginMetadata& PluginMetadataStore::get(size_t id) {
+        return entries.at(id);
+    }
+
+    void PluginMetadataStore::invalidate() {
+        for (auto& entry : entries)
+            entry.reset();
+    }
+}
@@ -0,0 +1,74 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_PLUGIN_METADATA_STORE_H__
+#define __LIBLO_PLUGIN_METADATA_STORE_H__
+
+#include "HeaderCache.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace liblo {
+    // A plugin's interned name and the facts about its file. Each fact is
+    // read from disk at most once until the store holding it is invalidated.
+    struct PluginMetadata {
+        PluginMetadata(const std::string& pluginName, uint64_t foldedHash);
+
+        void reset();  //Forgets the file facts, but not the name.
+
+        std::string name;  // As first spelt.
+        std::string folded;
+        uint64_t hash;  // FoldedHash of the name.
+
+        bool headerRead;
+        unsigned int headerErrorCode;  // LIBLO_OK if the header was read successfully.
+        std::string headerError;
+        PluginHeader header;
+    };
+
+    // Per-handle table of plugin names and metadata, shared by every Plugin
+    // object used with the handle. Each case-insensitively distinct name is
+    // interned once, so plugins can be compared by ID.
+    class PluginMetadataStore {
+    public:
+        PluginMetadataStore();
+
+        uint64_t Serial() const;  //Unique to this store, so plugins can tell stores apart.
+
+        size_t getId(const std::string& pluginName, uint64_t foldedHash);  //Interns the name if it's new.
+        PluginMetadata& get(size_t id);
+
+        void invalidate();  //Forgets all facts, but keeps plugin IDs valid.
+    private:
+        uint64_t serial;
+        std::vector<PluginMetadata> entries;
+        std::unordered_multimap<uint64_t, size_t> ids;  // Folded hash to entries.
+    };
+}
+
+#endif
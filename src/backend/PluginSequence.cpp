@@ -0,0 +1,327 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "PluginSequence.h"
+
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace std;
+
+namespace liblo {
+    constexpr size_t PluginSequence::nil;
+
+    PluginSequence::PluginSequence() : root(nil), masters(0) {}
+
+    size_t PluginSequence::size() const {
+        return sizeOf(root);
+    }
+
+    bool PluginSequence::empty() const {
+        return root == nil;
+    }
+
+    Plugin& PluginSequence::at(size_t position) {
+        return nodes[nodeAt(position)].plugin;
+    }
+
+    const Plugin& PluginSequence::at(size_t position) const {
+        return nodes[nodeAt(position)].plugin;
+    }
+
+    const Plugin& PluginSequence::front() const {
+        return nodes[first()].plugin;
+    }
+
+    PluginSequence::iterator PluginSequence::begin() {
+        return iterator(this, first());
+    }
+
+    PluginSequence::iterator PluginSequence::end() {
+        return iterator(this, nil);
+    }
+
+    PluginSequence::const_iterator PluginSequence::begin() const {
+        return const_iterator(this, first());
+    }
+
+    PluginSequence::const_iterator PluginSequence::end() const {
+        return const_iterator(this, nil);
+    }
+
+    vector<Plugin> PluginSequence::Plugins() const {
+        vector<Plugin> plugins;
+        plugins.reserve(size());
+        for (size_t node = first(); node != nil; node = successor(node))
+            plugins.push_back(nodes[node].plugin);
+        return plugins;
+    }
+
+    size_t PluginSequence::find(const Plugin& plugin) const {
+        size_t position = size();
+        auto range = index.equal_range(plugin);
+        for (auto it = range.first; it != range.second; ++it)
+            position = min(position, positionOf(it->second));
+        return position;
+    }
+
+    bool PluginSequence::contains(const Plugin& plugin) const {
+        return index.count(plugin) != 0;
+    }
+
+    bool PluginSequence::isMaster(size_t position) const {
+        return nodes[nodeAt(position)].isMaster;
+    }
+
+    size_t PluginSequence::masterCount() const {
+        return masters;
+    }
+
+    void PluginSequence::insert(size_t position, const Plugin& plugin, bool isMaster) {
+        if (position > size())
+            throw out_of_range("Cannot insert a plugin past the end of the load order.");
+
+        size_t node = newNode(plugin, isMaster);
+        size_t left, right;
+        split(root, position, left, right);
+        setRoot(merge(merge(left, node), right));
+    }
+
+    void PluginSequence::insert(size_t position, const vector<Plugin>& plugins, bool isMaster) {
+        if (position > size())
+            throw out_of_range("Cannot insert a plugin past the end of the load order.");
+
+        // Build the inserted plugins into their own treap, so the existing
+        // one is only split and merged once.
+        size_t inserted = nil;
+        for (const auto& plugin : plugins)
+            inserted = merge(inserted, newNode(plugin, isMaster));
+
+        size_t left, right;
+        split(root, position, left, right);
+        setRoot(merge(merge(left, inserted), right));
+    }
+
+    void PluginSequence::push_back(const Plugin& plugin, bool isMaster) {
+        setRoot(merge(root, newNode(plugin, isMaster)));
+    }
+
+    void PluginSequence::erase(size_t position) {
+        if (position >= size())
+            throw out_of_range("No plugin is at the given load order position.");
+
+        size_t left, middle, right;
+        split(root, position, left, middle);
+        split(middle, 1, middle, right);
+        setRoot(merge(left, right));
+        freeNode(middle);
+    }
+
+    void PluginSequence::clear() {
+        nodes.clear();
+        freeNodes.clear();
+        index.clear();
+        root = nil;
+        masters = 0;
+    }
+
+    void PluginSequence::removeDuplicates() {
+        // Walk backwards so that the last entry for each plugin is kept.
+        vector<size_t> order(inOrder());
+        vector<size_t> kept;
+        kept.reserve(order.size());
+        unordered_set<Plugin> seen;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            if (seen.insert(nodes[*it].plugin).second)
+                kept.push_back(*it);
+            else
+                freeNode(*it);
+        }
+        relink(vector<size_t>(kept.rbegin(), kept.rend()));
+    }
+
+    size_t PluginSequence::newNode(const Plugin& plugin, bool isMaster) {
+        Node node = { plugin, isMaster, static_cast<uint32_t>(random()), 1, nil, nil, nil };
+        size_t id;
+        if (freeNodes.empty()) {
+            id = nodes.size();
+            nodes.push_back(node);
+        }
+        else {
+            id = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[id] = node;
+        }
+        index.emplace(plugin, id);
+        masters += isMaster;
+        return id;
+    }
+
+    void PluginSequence::freeNode(size_t node) {
+        auto range = index.equal_range(nodes[node].plugin);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == node) {
+                index.erase(it);
+                break;
+            }
+        }
+        masters -= nodes[node].isMaster;
+        freeNodes.push_back(node);
+    }
+
+    size_t PluginSequence::sizeOf(size_t node) const {
+        return node == nil ? 0 : nodes[node].size;
+    }
+
+    void PluginSequence::update(size_t node) {
+        Node& n = nodes[node];
+        n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+        if (n.left != nil)
+            nodes[n.left].parent = node;
+        if (n.right != nil)
+            nodes[n.right].parent = node;
+    }
+
+    size_t PluginSequence::merge(size_t left, size_t right) {
+        if (left == nil)
+            return right;
+        if (right == nil)
+            return left;
+
+        if (nodes[left].priority > nodes[right].priority) {
+            size_t merged = merge(nodes[left].right, right);
+            nodes[left].right = merged;
+            update(left);
+            return left;
+        }
+        else {
+            size_t merged = merge(left, nodes[right].left);
+            nodes[right].left = merged;
+            update(right);
+            return right;
+        }
+    }
+
+    void PluginSequence::split(size_t node, size_t count, size_t& left, size_t& right) {
+        // Puts the first count plugins in the left tree and the rest in the
+        // right tree. The returned roots' parent links are left stale.
+        if (node == nil) {
+            left = right = nil;
+            return;
+        }
+
+        size_t leftSize = sizeOf(nodes[node].left);
+        if (leftSize < count) {
+            size_t lower;
+            split(nodes[node].right, count - leftSize - 1, lower, right);
+            nodes[node].right = lower;
+            left = node;
+        }
+        else {
+            size_t upper;
+            split(nodes[node].left, count, left, upper);
+            nodes[node].left = upper;
+            right = node;
+        }
+        update(node);
+    }
+
+    void PluginSequence::setRoot(size_t node) {
+        root = node;
+        if (root != nil)
+            nodes[root].parent = nil;
+    }
+
+    size_t PluginSequence::nodeAt(size_t position) const {
+        if (position >= size())
+            throw out_of_range("No plugin is at the given load order position.");
+
+        size_t node = root;
+        while (true) {
+            size_t leftSize = sizeOf(nodes[node].left);
+            if (position < leftSize)
+                node = nodes[node].left;
+            else if (position == leftSize)
+                return node;
+            else {
+                position -= leftSize + 1;
+                node = nodes[node].right;
+            }
+        }
+    }
+
+    size_t PluginSequence::positionOf(size_t node) const {
+        size_t position = sizeOf(nodes[node].left);
+        while (nodes[node].parent != nil) {
+            size_t parent = nodes[node].parent;
+            if (nodes[parent].right == node)
+                position += sizeOf(nodes[parent].left) + 1;
+            node = parent;
+        }
+        return position;
+    }
+
+    size_t PluginSequence::first() const {
+        size_t node = root;
+        if (node != nil) {
+            while (nodes[node].left != nil)
+                node = nodes[node].left;
+        }
+        return node;
+    }
+
+    size_t PluginSequence::successor(size_t node) const {
+        if (nodes[node].right != nil) {
+            node = nodes[node].right;
+            while (nodes[node].left != nil)
+                node = nodes[node].left;
+            return node;
+        }
+
+        size_t parent = nodes[node].parent;
+        while (parent != nil && nodes[parent].right == node) {
+            node = parent;
+            parent = nodes[node].parent;
+        }
+        return parent;
+    }
+
+    vector<size_t> PluginSequence::inOrder() const {
+        vector<size_t> order;
+        order.reserve(size());
+        for (size_t node = first(); node != nil; node = successor(node))
+            order.push_back(node);
+        return order;
+    }
+
+    void PluginSequence::relink(const vector<size_t>& order) {
+        root = nil;
+        for (size_t node : order) {
+            nodes[node].size = 1;
+            nodes[node].parent = nodes[node].left = nodes[node].right = nil;
+            setRoot(merge(root, node));
+        }
+    }
+}
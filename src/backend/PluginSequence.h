@@ -0,0 +1,182 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_PLUGIN_SEQUENCE_H__
+#define __LIBLO_PLUGIN_SEQUENCE_H__
+
+#include "Plugin.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace liblo {
+    // An ordered list of plugins, stored as an implicit treap so that
+    // plugins can be looked up, inserted and erased by position in
+    // logarithmic time. A case-insensitive index maps each plugin to its
+    // entry, and each entry records whether the plugin is a master, so the
+    // boundary between masters and non-masters is known without reading any
+    // plugin headers. If a plugin is listed more than once, its first
+    // position is the one found.
+    class PluginSequence {
+        static constexpr size_t nil = std::numeric_limits<size_t>::max();
+    public:
+        template<class Value, class Sequence>
+        class basic_iterator {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Value value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef Value* pointer;
+            typedef Value& reference;
+
+            basic_iterator() : sequence(nullptr), node(nil) {}
+            basic_iterator(Sequence * sequence, size_t node) : sequence(sequence), node(node) {}
+
+            reference operator*() const { return sequence->nodes[node].plugin; }
+            pointer operator->() const { return &sequence->nodes[node].plugin; }
+
+            bool isMaster() const { return sequence->nodes[node].isMaster; }
+
+            basic_iterator& operator++() {
+                node = sequence->successor(node);
+                return *this;
+            }
+            basic_iterator operator++(int) {
+                basic_iterator previous(*this);
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const basic_iterator& other) const { return node == other.node; }
+            bool operator!=(const basic_iterator& other) const { return node != other.node; }
+        private:
+            Sequence * sequence;
+            size_t node;
+        };
+
+        typedef basic_iterator<Plugin, PluginSequence> iterator;
+        typedef basic_iterator<const Plugin, const PluginSequence> const_iterator;
+
+        PluginSequence();
+
+        size_t size() const;
+        bool empty() const;
+
+        Plugin& at(size_t position);
+        const Plugin& at(size_t position) const;
+        const Plugin& front() const;
+
+        // Modifying plugins through iterators must not change their names.
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        std::vector<Plugin> Plugins() const;
+
+        size_t find(const Plugin& plugin) const;  //Returns size() if the plugin isn't listed.
+        bool contains(const Plugin& plugin) const;
+
+        // Whether the plugin at the given position was inserted as a master,
+        // and how many masters are listed. If all masters are listed before
+        // all non-masters, the latter is the position of the first non-master.
+        bool isMaster(size_t position) const;
+        size_t masterCount() const;
+
+        void insert(size_t position, const Plugin& plugin, bool isMaster);
+        void insert(size_t position, const std::vector<Plugin>& plugins, bool isMaster);  //Keeps the given order.
+        void push_back(const Plugin& plugin, bool isMaster);
+        void erase(size_t position);
+        void clear();
+
+        template<class Compare>
+        void sort(Compare compare) {
+            std::vector<size_t> order(inOrder());
+            std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+                return compare(nodes[lhs].plugin, nodes[rhs].plugin);
+            });
+            relink(order);
+        }
+
+        // Reclassifies every plugin using the given predicate, then moves
+        // masters before non-masters, preserving their relative order.
+        template<class IsMaster>
+        void partitionMasters(IsMaster isMaster) {
+            std::vector<size_t> order(inOrder());
+            masters = 0;
+            for (size_t node : order) {
+                nodes[node].isMaster = isMaster(nodes[node].plugin);
+                masters += nodes[node].isMaster;
+            }
+            std::stable_partition(order.begin(), order.end(), [&](size_t node) {
+                return nodes[node].isMaster;
+            });
+            relink(order);
+        }
+
+        void removeDuplicates();  //Keeps the last of each plugin's entries.
+    private:
+        struct Node {
+            Plugin plugin;
+            bool isMaster;
+            uint32_t priority;
+            size_t size;
+            size_t parent;
+            size_t left;
+            size_t right;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<size_t> freeNodes;
+        std::unordered_multimap<Plugin, size_t> index;
+        std::minstd_rand random;
+        size_t root;
+        size_t masters;
+
+        size_t newNode(const Plugin& plugin, bool isMaster);
+        void freeNode(size_t node);
+
+        size_t sizeOf(size_t node) const;
+        void update(size_t node);
+        size_t merge(size_t left, size_t right);
+        void split(size_t node, size_t count, size_t& left, size_t& right);
+        void setRoot(size_t node);
+
+        size_t nodeAt(size_t position) const;
+        size_t positionOf(size_t node) const;
+        size_t first() const;
+        size_t successor(size_t node) const;
+
+        std::vector<size_t> inOrder() const;
+        void relink(const std::vector<size_t>& order);
+    };
+}
+
+#endif
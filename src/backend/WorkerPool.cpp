@@ -0,0 +1,126 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include "WorkerPool.h"
+
+using namespace std;
+
+namespace liblo {
+    WorkerPool::WorkerPool() :
+        currentTask(nullptr),
+        taskCount(0),
+        nextIndex(0),
+        busyWorkers(0),
+        batch(0),
+        stopping(false) {}
+
+    WorkerPool::~WorkerPool() {
+        Stop();
+    }
+
+    void WorkerPool::Resize(size_t concurrency) {
+        Stop();
+
+        stopping = false;
+        for (size_t i = 1; i < concurrency; ++i)
+            workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+
+    size_t WorkerPool::Concurrency() const {
+        return workers.size() + 1;
+    }
+
+    void WorkerPool::ParallelFor(size_t count, const function<void(size_t)>& task) {
+        if (workers.empty() || count < 2) {
+            for (size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            currentTask = &task;
+            taskCount = count;
+            nextIndex = 0;
+            busyWorkers = workers.size();
+            firstError = nullptr;
+            ++batch;
+        }
+        workAvailable.notify_all();
+
+        RunTasks();
+
+        unique_lock<std::mutex> lock(mutex);
+        workFinished.wait(lock, [&] { return busyWorkers == 0; });
+        currentTask = nullptr;
+
+        if (firstError)
+            rethrow_exception(firstError);
+    }
+
+    void WorkerPool::WorkerLoop() {
+        uint64_t lastBatch = 0;
+        while (true) {
+            {
+                unique_lock<std::mutex> lock(mutex);
+                workAvailable.wait(lock, [&] { return stopping || batch != lastBatch; });
+                if (stopping)
+                    return;
+                lastBatch = batch;
+            }
+
+            RunTasks();
+
+            lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0)
+                workFinished.notify_one();
+        }
+    }
+
+    void WorkerPool::RunTasks() {
+        for (size_t i = nextIndex++; i < taskCount; i = nextIndex++) {
+            try {
+                (*currentTask)(i);
+            }
+            catch (...) {
+                lock_guard<std::mutex> lock(mutex);
+                if (!firstError)
+                    firstError = current_exception();
+            }
+        }
+    }
+
+    void WorkerPool::Stop() {
+        {
+            lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+
+        for (auto& worker : workers)
+            worker.join();
+        workers.clear();
+    }
+}
@@ -0,0 +1,72 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#ifndef __LIBLO_WORKER_POOL_H__
+#define __LIBLO_WORKER_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace liblo {
+    // A fixed set of threads that share out the iterations of a loop with
+    // the calling thread. Used to overlap slow filesystem reads.
+    class WorkerPool {
+    public:
+        WorkerPool();
+        ~WorkerPool();
+
+        void Resize(size_t concurrency);  //Includes the calling thread, so 1 means no workers.
+        size_t Concurrency() const;
+
+        // Calls task(i) for every i in [0, count), and returns once all calls
+        // have finished. If any call throws, the first exception is rethrown.
+        void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable workFinished;
+
+        const std::function<void(size_t)> * currentTask;
+        size_t taskCount;
+        std::atomic<size_t> nextIndex;
+        size_t busyWorkers;
+        uint64_t batch;
+        bool stopping;
+        std::exception_ptr firstError;
+
+        void WorkerLoop();
+        void RunTasks();
+        void Stop();
+    };
+}
+
+#endif
@@ -24,10 +24,12 @@
         */
 
 #include "error.h"
-#include <cstring>
 
 namespace liblo {
-    char * extErrorString = nullptr;
+    // Dynamic messages are copied into a per-thread string that's reused,
+    // while messages that are string literals are just pointed to.
+    static thread_local const char * lastErrorMessage = nullptr;
+    static thread_local std::string lastErrorText;
 
     error::error(const unsigned int code, const std::string& what) : _code(code), _what(what) {}
 
@@ -41,19 +43,36 @@ namespace liblo {
         return _what.c_str();
     }
 
-    unsigned int c_error(const error& e) {
-        delete[] extErrorString;
+    const char * LastErrorMessage() {
+        return lastErrorMessage;
+    }
+
+    void ClearErrorMessage() {
+        lastErrorMessage = nullptr;
+        std::string().swap(lastErrorText);
+    }
+
+    static unsigned int recordError(const unsigned int code, const char * what) {
         try {
-            extErrorString = new char[strlen(e.what()) + 1];
-            strcpy(extErrorString, e.what());
+            lastErrorText.assign(what);
+            lastErrorMessage = lastErrorText.c_str();
         }
         catch (std::bad_alloc& /*e*/) {
-            extErrorString = nullptr;
+            lastErrorMessage = nullptr;
         }
-        return e.code();
+        return code;
+    }
+
+    unsigned int c_error(const error& e) {
+        return recordError(e.code(), e.what());
     }
 
     unsigned int c_error(const unsigned int code, const std::string& what) {
-        return c_error(error(code, what.c_str()));
+        return recordError(code, what.c_str());
+    }
+
+    unsigned int c_error_literal(const unsigned int code, const char * what) {
+        lastErrorMessage = what;
+        return code;
     }
 }
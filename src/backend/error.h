@@ -42,11 +42,18 @@ namespace liblo {
         unsigned int _code;
     };
 
-    extern char * extErrorString;
+    // The calling thread's last error message, or null if it has had none.
+    const char * LastErrorMessage();
+    void ClearErrorMessage();  //Also frees the calling thread's message storage.
 
+    // These record the message as the calling thread's last error message
+    // and return the code.
     unsigned int c_error(const error& e);
 
     unsigned int c_error(const unsigned int code, const std::string& what);
+
+    // Records the message without copying it, so only pass string literals.
+    unsigned int c_error_literal(const unsigned int code, const char * what);
 }
 
 #endif
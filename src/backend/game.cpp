@@ -28,6 +28,10 @@
 #include "helpers.h"
 #include "error.h"
 
+#include <algorithm>
+#include <system_error>
+#include <unordered_map>
+
 #ifdef _WIN32
 #   ifndef UNICODE
 #       define UNICODE
@@ -44,12 +48,34 @@ using namespace liblo;
 
 namespace fs = boost::filesystem;
 
+namespace {
+    struct ThreadOutputBuffer {
+        std::weak_ptr<void> handleLifetime;
+        StringArrayBuffer buffer;
+    };
+
+    //Output buffers of the thread-safe handles used by the current thread.
+    //They're keyed by handle address, which may be reused once a handle is
+    //destroyed, so each also tracks whether its own handle still exists.
+    thread_local std::unordered_map<const void *, ThreadOutputBuffer> threadOutputBuffers;
+}
+
 _lo_game_handle_int::_lo_game_handle_int(unsigned int gameId, const string& path)
     : id(gameId),
+    useHeaderCache(false),
+    watchChanges(false),
+    saveDurability(LIBLO_DURABILITY_NONE),
+    inTransaction(false),
+    loadOrderChanged(false),
+    activePluginsChanged(false),
+    loadOrderKeptForUndo(false),
+    activePluginsKeptForUndo(false),
+    checkpointLoadOrderChanged(false),
+    checkpointActivePluginsChanged(false),
+    threadSafe(false),
+    lifetime(std::make_shared<char>()),
     gamePath(path),
-    extString(nullptr),
-    extStringArray(nullptr),
-    extStringArraySize(0) {
+    extString(nullptr) {
     // usual case...
     pluginsFolderName = "Data";
     pluginsFileName = "plugins.txt";
@@ -90,30 +116,39 @@ _lo_game_handle_int::_lo_game_handle_int(unsigned int gameId, const string& path
 }
 
 _lo_game_handle_int::~_lo_game_handle_int() {
-    delete[] extString;
-    freeStringArray();
-}
-
-void _lo_game_handle_int::freeStringArray() {
-    if (extStringArray != nullptr) {
-        for (size_t i = 0; i < extStringArraySize; ++i)
-            delete[] extStringArray[i];  //Clear all the char strings created.
-        delete[] extStringArray;  //Clear the string array.
-        extStringArray = nullptr;
-        extStringArraySize = 0;
+    try {
+        SaveHeaderCache();
     }
+    catch (std::exception& /*e*/) {}
+    delete[] extString;
+    threadOutputBuffers.erase(this);
 }
 
 void _lo_game_handle_int::InitPaths(const boost::filesystem::path& localPath) {
+    headerCachePath = localPath / "libloadorder.cache";
+
     //Set active plugins and load order files.
     if (id == LIBLO_GAME_TES4 && fs::exists(gamePath / "Oblivion.ini")) {
-        //Looking up bUseMyGamesDirectory, which only has effect if =0 and exists in Oblivion folder. Messy code, but one lookup hardly qualifies for a full ini parser to be included.
+        //Looking up bUseMyGamesDirectory, which only has effect if =0 and exists in Oblivion folder.
+        //It belongs in [General], which is the first section, so the scan usually stops early.
         string iniContent;
-        string iniSetting = "bUseMyGamesDirectory=";
         fileToBuffer(gamePath / "Oblivion.ini", iniContent);
 
-        size_t pos = iniContent.find(iniSetting);
-        if (pos != string::npos && pos + iniSetting.length() < iniContent.length() && iniContent[pos + iniSetting.length()] == '0') {
+        bool useMyGamesDirectory = true;
+        bool inGeneral = false;
+        ScanIni(iniContent, [&](const IniSetting& setting) {
+            if (!setting.section.empty()) {
+                if (!FoldedEquals(setting.section, "General"))
+                    return !inGeneral;  //Stop once past [General].
+                inGeneral = true;
+            }
+            if (!FoldedEquals(setting.key, "bUseMyGamesDirectory"))
+                return true;
+            useMyGamesDirectory = setting.value.empty() || setting.value.front() != '0';
+            return false;
+        });
+
+        if (!useMyGamesDirectory) {
             pluginsPath = gamePath / pluginsFileName;
             loadorderPath = gamePath / "loadorder.txt";
         }
@@ -145,6 +180,96 @@ void _lo_game_handle_int::SetMasterFile(const string& file) {
 
 void _lo_game_handle_int::SetLocalAppData(const boost::filesystem::path& localPath) {
     InitPaths(localPath);
+    if (useHeaderCache)
+        headerCache.Load(headerCachePath, id);
+    if (watchChanges)
+        SetChangeWatching(true);
+}
+
+void _lo_game_handle_int::SetHeaderCacheEnabled(bool enable) {
+    if (enable && headerCachePath.empty())
+        throw error(LIBLO_ERROR_INVALID_ARGS, "No local app data path set.");
+
+    if (enable && !useHeaderCache)
+        headerCache.Load(headerCachePath, id);
+    else if (!enable)
+        headerCache.clear();
+
+    useHeaderCache = enable;
+}
+
+void _lo_game_handle_int::SetWorkerThreads(unsigned int count) {
+    if (count > 64)
+        throw error(LIBLO_ERROR_INVALID_ARGS, "Too many worker threads requested.");
+
+    try {
+        workerPool.Resize(count);
+    }
+    catch (std::system_error& e) {
+        workerPool.Resize(1);
+        throw error(LIBLO_ERROR_NO_MEM, e.what());
+    }
+}
+
+void _lo_game_handle_int::SetChangeWatching(bool enable) {
+    if (!enable) {
+        changeWatcher.Stop();
+        watchChanges = false;
+        return;
+    }
+
+    if (!liblo::ChangeWatcher::IsSupported())
+        throw error(LIBLO_ERROR_INVALID_ARGS, "Watching for changes is not supported on this platform.");
+
+    changeWatcher.Start(PluginsFolder(),
+                        loMethod == LIBLO_METHOD_TEXTFILE ? LoadOrderFile() : fs::path(),
+                        ActivePluginsFile());
+    watchChanges = true;
+}
+
+void _lo_game_handle_int::SetSaveDurability(unsigned int durability) {
+    if (durability != LIBLO_DURABILITY_NONE && durability != LIBLO_DURABILITY_FILE && durability != LIBLO_DURABILITY_FOLDER)
+        throw error(LIBLO_ERROR_INVALID_ARGS, "Invalid save durability specified.");
+
+    saveDurability = durability;
+}
+
+void _lo_game_handle_int::SetThreadSafe(bool enable) {
+    threadSafe = enable;
+}
+
+std::shared_lock<std::shared_timed_mutex> _lo_game_handle_int::LockShared() const {
+    if (threadSafe)
+        return std::shared_lock<std::shared_timed_mutex>(mutex);
+    return std::shared_lock<std::shared_timed_mutex>(mutex, std::defer_lock);
+}
+
+std::unique_lock<std::shared_timed_mutex> _lo_game_handle_int::LockExclusive() const {
+    if (threadSafe)
+        return std::unique_lock<std::shared_timed_mutex>(mutex);
+    return std::unique_lock<std::shared_timed_mutex>(mutex, std::defer_lock);
+}
+
+liblo::StringArrayBuffer& _lo_game_handle_int::OutputBuffer() {
+    if (!threadSafe)
+        return outputBuffer;
+
+    auto it = threadOutputBuffers.find(this);
+    if (it != threadOutputBuffers.end() && !it->second.handleLifetime.expired())
+        return it->second.buffer;
+
+    //Drop the buffers of destroyed handles, so that a long-lived thread
+    //doesn't keep accumulating them.
+    for (auto jt = threadOutputBuffers.begin(); jt != threadOutputBuffers.end();) {
+        if (jt->second.handleLifetime.expired())
+            jt = threadOutputBuffers.erase(jt);
+        else
+            ++jt;
+    }
+
+    ThreadOutputBuffer& entry = threadOutputBuffers[this];
+    entry.handleLifetime = lifetime;
+    return entry.buffer;
 }
 
 unsigned int _lo_game_handle_int::Id() const {
@@ -168,6 +293,210 @@ unsigned int _lo_game_handle_int::LoadOrderMethod() const {
     return loMethod;
 }
 
+unsigned int _lo_game_handle_int::SaveDurability() const {
+    return saveDurability;
+}
+
+liblo::DataDirSnapshot& _lo_game_handle_int::DataDir() const {
+    if (!dataDir.IsValid())
+        dataDir.Build(PluginsFolder());
+    return dataDir;
+}
+
+bool _lo_game_handle_int::DataDirMatches(const liblo::DataDirFingerprint& fingerprint) const {
+    //The cached listing can only be trusted if the change watcher says the
+    //folder hasn't changed since, otherwise list it again without caching.
+    if (dataDir.IsValid() && changeWatcher.Covers(liblo::ChangeWatcher::PLUGIN_DATA)
+        && !changeWatcher.IsDirty(liblo::ChangeWatcher::PLUGIN_DATA))
+        return dataDir.Matches(fingerprint);
+
+    liblo::DataDirSnapshot current;
+    current.Build(PluginsFolder());
+    return current.Matches(fingerprint);
+}
+
+void _lo_game_handle_int::InvalidatePluginData() const {
+    if (changeWatcher.Covers(liblo::ChangeWatcher::PLUGIN_DATA)) {
+        if (!changeWatcher.IsDirty(liblo::ChangeWatcher::PLUGIN_DATA))
+            return;
+        changeWatcher.MarkClean(liblo::ChangeWatcher::PLUGIN_DATA);
+    }
+    pluginMetadata.invalidate();
+    dataDir.Invalidate();
+}
+
+void _lo_game_handle_int::KeepPluginList(const fs::path& file, const FileFingerprint& fingerprint, const vector<string>& lines) const {
+    for (auto& kept : keptPluginLists) {
+        if (kept.file == file) {
+            kept.fingerprint = fingerprint;
+            kept.lines = lines;
+            return;
+        }
+    }
+    keptPluginLists.push_back({file, fingerprint, lines});
+}
+
+bool _lo_game_handle_int::TakePluginList(const fs::path& file, vector<string>& lines) const {
+    for (auto it = keptPluginLists.begin(); it != keptPluginLists.end(); ++it) {
+        if (it->file != file)
+            continue;
+
+        FileFingerprint current;
+        bool unchanged = current.read(file) && current == it->fingerprint;
+        if (unchanged)
+            lines.swap(it->lines);
+        keptPluginLists.erase(it);
+        return unchanged;
+    }
+    return false;
+}
+
+bool _lo_game_handle_int::InTransaction() const {
+    return inTransaction;
+}
+
+void _lo_game_handle_int::BeginTransaction() {
+    if (inTransaction)
+        throw error(LIBLO_ERROR_INVALID_ARGS, "A transaction is already open.");
+
+    InvalidatePluginData();
+    if (loadOrder.HasChanged(*this))
+        loadOrder.Load(*this);
+    if (activePlugins.HasChanged(*this))
+        activePlugins.Load(*this);
+
+    inTransaction = true;
+    loadOrderChanged = false;
+    activePluginsChanged = false;
+}
+
+void _lo_game_handle_int::CommitTransaction() {
+    if (!inTransaction)
+        throw error(LIBLO_ERROR_INVALID_ARGS, "No transaction is open.");
+
+    // Leave the transaction open if validation fails, so that the changes
+    // can be corrected or discarded.
+    InvalidatePluginData();
+    try {
+        if (loadOrderChanged)
+            loadOrder.CheckValidity(*this, false);
+        if (activePluginsChanged)
+            activePlugins.CheckValidity(*this);
+    }
+    catch (error& e) {
+        throw error(LIBLO_ERROR_INVALID_ARGS, string("The transaction's changes are invalid. Details: ") + e.what());
+    }
+
+    // The transaction stays open while saving so that the files being
+    // written aren't seen as external changes and reloaded.
+    try {
+        if (loadOrderChanged)
+            loadOrder.Save(*this);
+        // Saving a textfile-based load order also saves the active plugins.
+        if (activePluginsChanged && !(loadOrderChanged && loMethod == LIBLO_METHOD_TEXTFILE))
+            activePlugins.Save(*this);
+    }
+    catch (error&) {
+        AbortTransaction();
+        throw;
+    }
+
+    inTransaction = false;
+}
+
+void _lo_game_handle_int::AbortTransaction() {
+    loadOrder.clear();
+    activePlugins.clear();
+    undoLog.clear();
+    inTransaction = false;
+}
+
+void _lo_game_handle_int::BeginChange() {
+    undoLog.clear();
+    loadOrderKeptForUndo = false;
+    activePluginsKeptForUndo = false;
+    checkpointLoadOrderChanged = loadOrderChanged;
+    checkpointActivePluginsChanged = activePluginsChanged;
+}
+
+void _lo_game_handle_int::KeepLoadOrderForUndo() {
+    if (!inTransaction || loadOrderKeptForUndo)
+        return;
+
+    loadOrderKeptForUndo = true;
+    undoLog.push_back([this, kept = loadOrder]() mutable {
+        loadOrder = std::move(kept);
+    });
+}
+
+void _lo_game_handle_int::KeepActivePluginsForUndo() {
+    if (!inTransaction || activePluginsKeptForUndo)
+        return;
+
+    activePluginsKeptForUndo = true;
+    undoLog.push_back([this, kept = activePlugins]() mutable {
+        activePlugins = std::move(kept);
+    });
+}
+
+void _lo_game_handle_int::KeepActiveStateForUndo(const Plugin& plugin) {
+    if (!inTransaction || activePluginsKeptForUndo)
+        return;
+
+    //Only the one plugin changes, so there's no need to copy the whole set,
+    //just remember where it was listed.
+    bool wasActive = activePlugins.find(plugin) != activePlugins.end();
+    const auto& ordered = activePlugins.Ordered();
+    size_t orderedIndex = std::find(ordered.begin(), ordered.end(), plugin) - ordered.begin();
+    undoLog.push_back([this, plugin, wasActive, orderedIndex]() {
+        auto it = activePlugins.find(plugin);
+        if (wasActive && it == activePlugins.end())
+            activePlugins.insert(plugin, orderedIndex);
+        else if (!wasActive && it != activePlugins.end())
+            activePlugins.erase(it);
+    });
+}
+
+void _lo_game_handle_int::RevertChange() {
+    if (inTransaction) {
+        for (auto it = undoLog.rbegin(); it != undoLog.rend(); ++it)
+            (*it)();
+        undoLog.clear();
+        loadOrderChanged = checkpointLoadOrderChanged;
+        activePluginsChanged = checkpointActivePluginsChanged;
+    }
+    else {
+        loadOrder.clear();
+        activePlugins.clear();
+    }
+}
+
+void _lo_game_handle_int::SaveLoadOrder() {
+    if (inTransaction)
+        loadOrderChanged = true;
+    else
+        loadOrder.Save(*this);
+}
+
+void _lo_game_handle_int::SaveActivePlugins() {
+    if (inTransaction)
+        activePluginsChanged = true;
+    else
+        activePlugins.Save(*this);
+}
+
+void _lo_game_handle_int::AddInstalledPluginsToLoadOrder() {
+    // Reloading would lose a transaction's changes, so just add the missing
+    // plugins to the cached load order.
+    if (inTransaction) {
+        KeepLoadOrderForUndo();
+        loadOrder.LoadAdditionalFiles(*this);
+    }
+    else
+        loadOrder.Load(*this);
+    SaveLoadOrder();
+}
+
 boost::filesystem::path _lo_game_handle_int::PluginsFolder() const {
     return gamePath / pluginsFolderName;
 }
@@ -187,6 +516,15 @@ boost::filesystem::path _lo_game_handle_int::LoadOrderFile() const {
     return loadorderPath;
 }
 
+bool _lo_game_handle_int::UsesHeaderCache() const {
+    return useHeaderCache;
+}
+
+void _lo_game_handle_int::SaveHeaderCache() const {
+    if (useHeaderCache)
+        headerCache.Save(headerCachePath, id);
+}
+
 #ifdef _WIN32
 boost::filesystem::path _lo_game_handle_int::GetLocalAppDataPath() const {
     HWND owner = 0;
@@ -27,6 +27,16 @@
 #define __LIBLO_GAME_H__
 
 #include "LoadOrder.h"
+#include "ChangeWatcher.h"
+#include "DataDirSnapshot.h"
+#include "HeaderCache.h"
+#include "PluginMetadataStore.h"
+#include "WorkerPool.h"
+#include "helpers.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <stdint.h>
@@ -41,27 +51,107 @@ public:
 
     void SetMasterFile(const std::string& file);
     void SetLocalAppData(const boost::filesystem::path& localPath);
+    void SetHeaderCacheEnabled(bool enable);  //Loads the on-disk header cache when enabled.
+    void SetWorkerThreads(unsigned int count);  //0 or 1 reads plugin files serially.
+    void SetChangeWatching(bool enable);
+    void SetSaveDurability(unsigned int durability);
+    void SetThreadSafe(bool enable);  //Must be set before the handle is shared between threads.
 
     unsigned int Id() const;
     libespm::GameId getLibespmId() const;
     std::string MasterFile() const;
     unsigned int LoadOrderMethod() const;
+    unsigned int SaveDurability() const;
 
     boost::filesystem::path PluginsFolder() const;
     boost::filesystem::path ActivePluginsFile() const;
     boost::filesystem::path LoadOrderFile() const;
 
+    liblo::DataDirSnapshot& DataDir() const;  //Lists the plugins folder if it hasn't been since the last invalidation.
+    bool DataDirMatches(const liblo::DataDirFingerprint& fingerprint) const;  //Doesn't modify the handle, so is safe under the shared lock.
+    void InvalidatePluginData() const;  //Plugin files may have changed, so forget what's known about them, unless the change watcher says otherwise.
+
+    // Plugin lists read from a file outside of a load, eg. to check that the
+    // files are synchronised, are kept for the next load of that file, which
+    // takes them if the file is unchanged since its fingerprint was read.
+    void KeepPluginList(const boost::filesystem::path& file, const liblo::FileFingerprint& fingerprint, const std::vector<std::string>& lines) const;
+    bool TakePluginList(const boost::filesystem::path& file, std::vector<std::string>& lines) const;
+
+    bool UsesHeaderCache() const;
+    void SaveHeaderCache() const;  //Writes the header cache to disk if it's enabled and has changed.
+
+    // While a transaction is open, the cached load order and active plugins
+    // aren't reloaded, and changes to them are validated and saved once, on
+    // commit.
+    bool InTransaction() const;
+    void BeginTransaction();
+    void CommitTransaction();
+    void AbortTransaction();  //Clears the cached lists so they're reloaded.
+
+    // Within a transaction, a change records how to undo what it does to the
+    // cached lists, so that a failed change can be reverted without losing
+    // the transaction's earlier changes. Outside one there's nothing to undo.
+    void BeginChange();
+    void KeepLoadOrderForUndo();  //Copies the load order, once per change, before it's rewritten.
+    void KeepActivePluginsForUndo();  //Copies the active plugins, once per change, before they're rewritten.
+    void KeepActiveStateForUndo(const liblo::Plugin& plugin);  //Before a single plugin is activated or deactivated.
+    void RevertChange();  //Within a transaction, undoes the change, otherwise clears the lists so they're reloaded.
+
+    void SaveLoadOrder();  //Saves now, or on commit if a transaction is open.
+    void SaveActivePlugins();  //Saves now, or on commit if a transaction is open.
+    void AddInstalledPluginsToLoadOrder();  //Adds any installed plugins the load order is missing, then saves it.
+
     liblo::LoadOrder loadOrder;
     liblo::ActivePlugins activePlugins;
+    mutable liblo::HeaderCache headerCache;
+    mutable liblo::PluginMetadataStore pluginMetadata;
+    mutable liblo::WorkerPool workerPool;
+    mutable liblo::ChangeWatcher changeWatcher;
 
     char * extString;
-    char ** extStringArray;
-    void freeStringArray();
 
-    size_t extStringArraySize;
+    // Locks for API calls, which only lock anything once the handle is
+    // thread-safe. Calls that only read the cached lists share the handle,
+    // while calls that change them, including reloading them, have it to
+    // themselves.
+    std::shared_lock<std::shared_timed_mutex> LockShared() const;
+    std::unique_lock<std::shared_timed_mutex> LockExclusive() const;
+
+    // The buffer for string arrays output through the API. Once the handle
+    // is thread-safe each calling thread gets its own, so a thread's output
+    // stays valid until that thread's next call. Those buffers are freed
+    // when their thread exits, or when it next needs a new buffer after the
+    // handle has been destroyed.
+    liblo::StringArrayBuffer& OutputBuffer();
 private:
     unsigned int id;
     unsigned int loMethod;
+    bool useHeaderCache;
+    bool watchChanges;
+    unsigned int saveDurability;
+    bool inTransaction;
+    bool loadOrderChanged;
+    bool activePluginsChanged;
+
+    std::vector<std::function<void()>> undoLog;  //Run in reverse to revert the current change.
+    bool loadOrderKeptForUndo;
+    bool activePluginsKeptForUndo;
+    bool checkpointLoadOrderChanged;
+    bool checkpointActivePluginsChanged;
+
+    mutable liblo::DataDirSnapshot dataDir;
+
+    struct KeptPluginList {
+        boost::filesystem::path file;
+        liblo::FileFingerprint fingerprint;
+        std::vector<std::string> lines;
+    };
+    mutable std::vector<KeptPluginList> keptPluginLists;
+
+    bool threadSafe;
+    mutable std::shared_timed_mutex mutex;
+    liblo::StringArrayBuffer outputBuffer;
+    std::shared_ptr<void> lifetime;  //Lets per-thread output buffers tell whether their handle still exists.
 
     std::string masterFile;
 
@@ -72,6 +162,7 @@ private:
     boost::filesystem::path gamePath;
     boost::filesystem::path pluginsPath;
     boost::filesystem::path loadorderPath;
+    boost::filesystem::path headerCachePath;
 
 #ifdef _WIN32
     boost::filesystem::path GetLocalAppDataPath() const;
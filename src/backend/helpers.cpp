@@ -25,12 +25,29 @@
 
 #include "libloadorder/constants.h"
 #include "helpers.h"
+#include "CaseFolding.h"
 #include "error.h"
 #include <cstring>
-#include <boost/locale.hpp>
+#include <system_error>
 #include <boost/filesystem/fstream.hpp>
 
+#ifdef _WIN32
+#   ifndef UNICODE
+#       define UNICODE
+#   endif
+#   ifndef _UNICODE
+#      define _UNICODE
+#   endif
+#   include "windows.h"
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
 using namespace std;
+namespace fs = boost::filesystem;
 
 namespace liblo {
     // std::string to null-terminated char string converter.
@@ -39,40 +56,331 @@ namespace liblo {
         return strcpy(p, str.c_str());
     }
 
+    void StringArrayBuffer::clear() {
+        //clear() keeps the capacity, so later lists reuse the allocations.
+        buffer.clear();
+        offsets.clear();
+        pointers.clear();
+    }
+
+    void StringArrayBuffer::push_back(const string& str) {
+        //Store offsets rather than pointers, as the buffer may move as it grows.
+        offsets.push_back(buffer.size());
+        buffer.insert(buffer.end(), str.begin(), str.end());
+        buffer.push_back('\0');
+    }
+
+    char ** StringArrayBuffer::data() {
+        if (offsets.empty())
+            return nullptr;
+
+        pointers.resize(offsets.size());
+        for (size_t i = 0; i < offsets.size(); ++i)
+            pointers[i] = buffer.data() + offsets[i];
+
+        return pointers.data();
+    }
+
+    size_t StringArrayBuffer::size() const {
+        return offsets.size();
+    }
+
     //Reads an entire file into a string buffer.
     void fileToBuffer(const boost::filesystem::path& file, string& buffer) {
+        buffer.clear();
         try {
-            boost::filesystem::ifstream ifile(file);
+            boost::filesystem::ifstream ifile(file, ios::binary);
             ifile.exceptions(std::ios_base::badbit);
             if (ifile.fail())
                 return;
-            ifile.unsetf(ios::skipws); // No white space skipping!
-            copy(
-                istream_iterator<char>(ifile),
-                istream_iterator<char>(),
-                back_inserter(buffer)
-                );
+
+            // Read the whole file at once, rather than through the stream's
+            // formatting one character at a time.
+            ifile.seekg(0, ios::end);
+            streamoff size = ifile.tellg();
+            ifile.seekg(0, ios::beg);
+            if (size > 0) {
+                buffer.resize(static_cast<size_t>(size));
+                ifile.read(&buffer[0], size);
+                buffer.resize(static_cast<size_t>(ifile.gcount()));
+            }
         }
         catch (std::ios_base::failure& e) {
             throw error(LIBLO_ERROR_FILE_READ_FAIL, "\"" + file.string() + "\" could not be read. Details: " + e.what());
         }
+
+#ifdef _WIN32
+        // Match a text mode read.
+        size_t length = 0;
+        for (size_t i = 0; i < buffer.length(); ++i) {
+            if (buffer[i] != '\r' || i + 1 == buffer.length() || buffer[i + 1] != '\n')
+                buffer[length++] = buffer[i];
+        }
+        buffer.resize(length);
+#endif
     }
 
-    std::string ToUTF8(const std::string& str) {
-        try {
-            return boost::locale::conv::to_utf<char>(str, "Windows-1252", boost::locale::conv::stop);
+    static error writeError(const fs::path& file, int code) {
+        return error(LIBLO_ERROR_FILE_WRITE_FAIL, "\"" + file.string() + "\" could not be written. Details: " + system_category().message(code));
+    }
+
+    //Follows any symlinks to the file they point to, so that it's that file
+    //which gets replaced rather than the link. The file needn't exist yet.
+    static fs::path resolveSymlinks(const fs::path& file) {
+        fs::path target = file;
+        for (int i = 0; i < 40; ++i) {
+            boost::system::error_code ec;
+            if (!fs::is_symlink(fs::symlink_status(target, ec)))
+                return target;
+
+            fs::path link = fs::read_symlink(target, ec);
+            if (ec)
+                throw writeError(file, ec.value());
+            target = link.is_absolute() ? link : target.parent_path() / link;
+        }
+        throw error(LIBLO_ERROR_FILE_WRITE_FAIL, "\"" + file.string() + "\" could not be written. Details: "
+                    + generic_category().message(static_cast<int>(errc::too_many_symbolic_link_levels)));
+    }
+
+    void bufferToFile(const fs::path& file, const string& buffer, unsigned int durability) {
+        const fs::path target = resolveSymlinks(file);
+        fs::path folder = target.has_parent_path() ? target.parent_path() : fs::path(".");
+        fs::path temp = folder / fs::unique_path(target.filename().string() + ".%%%%-%%%%.tmp");
+#ifdef _WIN32
+        string contents;
+        contents.reserve(buffer.size());
+        for (char c : buffer) {
+            if (c == '\n')
+                contents += '\r';
+            contents += c;
+        }
+
+        HANDLE handle = CreateFile(temp.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            throw writeError(file, GetLastError());
+
+        DWORD written = 0;
+        bool ok = WriteFile(handle, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr) != 0
+            && written == contents.size();
+        if (ok && durability != LIBLO_DURABILITY_NONE)
+            ok = FlushFileBuffers(handle) != 0;
+        DWORD code = GetLastError();
+        CloseHandle(handle);
+
+        // Windows has no way to flush a folder, but can wait for the rename
+        // to reach the disk.
+        DWORD flags = MOVEFILE_REPLACE_EXISTING;
+        if (durability == LIBLO_DURABILITY_FOLDER)
+            flags |= MOVEFILE_WRITE_THROUGH;
+        if (ok && !MoveFileEx(temp.wstring().c_str(), target.wstring().c_str(), flags)) {
+            ok = false;
+            code = GetLastError();
+        }
+        if (!ok) {
+            DeleteFile(temp.wstring().c_str());
+            throw writeError(file, code);
+        }
+#else
+        int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd == -1)
+            throw writeError(file, errno);
+
+        // Keep the permissions of the file being replaced.
+        struct stat status;
+        bool ok = stat(target.c_str(), &status) != 0 || fchmod(fd, status.st_mode & 07777) == 0;
+
+        const char * data = buffer.data();
+        size_t remaining = buffer.size();
+        while (ok && remaining > 0) {
+            ssize_t written = write(fd, data, remaining);
+            if (written > 0) {
+                data += written;
+                remaining -= written;
+            }
+            else if (written == 0) {
+                // No progress would be made by retrying, eg. if the disk is full.
+                errno = ENOSPC;
+                ok = false;
+            }
+            else if (errno != EINTR)
+                ok = false;
+        }
+        if (ok && durability != LIBLO_DURABILITY_NONE)
+            ok = fsync(fd) == 0;
+        int code = errno;
+        if (close(fd) != 0 && ok) {
+            ok = false;
+            code = errno;
+        }
+        if (ok && rename(temp.c_str(), target.c_str()) != 0) {
+            ok = false;
+            code = errno;
         }
-        catch (boost::locale::conv::conversion_error& /*e*/) {
-            throw error(LIBLO_WARN_BAD_FILENAME, "\"" + str + "\" cannot be encoded in Windows-1252.");
+        if (!ok) {
+            unlink(temp.c_str());
+            throw writeError(file, code);
         }
+
+        // Flush the folder too, so that the rename itself is durable.
+        if (durability == LIBLO_DURABILITY_FOLDER) {
+            int folderFd = open(folder.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (folderFd == -1)
+                throw writeError(file, errno);
+            ok = fsync(folderFd) == 0;
+            code = errno;
+            close(folderFd);
+            if (!ok)
+                throw writeError(file, code);
+        }
+#endif
     }
 
-    std::string FromUTF8(const std::string& str) {
-        try {
-            return boost::locale::conv::from_utf<char>(str, "Windows-1252", boost::locale::conv::stop);
+    //The Unicode code points of the Windows-1252 bytes. The five bytes that
+    //Windows-1252 leaves undefined are 0, as only NUL itself maps to 0.
+    static const uint16_t windows1252CodePoints[256] = {
+        0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F,
+        0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017, 0x0018, 0x0019, 0x001A, 0x001B, 0x001C, 0x001D, 0x001E, 0x001F,
+        0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+        0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+        0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+        0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+        0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+        0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x007F,
+        0x20AC, 0x0000, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x0000, 0x017D, 0x0000,
+        0x0000, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x0000, 0x017E, 0x0178,
+        0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7, 0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF,
+        0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7, 0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF,
+        0x00C0, 0x00C1, 0x00C2, 0x00C3, 0x00C4, 0x00C5, 0x00C6, 0x00C7, 0x00C8, 0x00C9, 0x00CA, 0x00CB, 0x00CC, 0x00CD, 0x00CE, 0x00CF,
+        0x00D0, 0x00D1, 0x00D2, 0x00D3, 0x00D4, 0x00D5, 0x00D6, 0x00D7, 0x00D8, 0x00D9, 0x00DA, 0x00DB, 0x00DC, 0x00DD, 0x00DE, 0x00DF,
+        0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, 0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF,
+        0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, 0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF,
+    };
+
+    //Returns the Windows-1252 byte for a code point, or -1 if there isn't one.
+    static int windows1252Byte(uint32_t codePoint) {
+        if (codePoint < 0x80 || (codePoint >= 0xA0 && codePoint <= 0xFF))
+            return static_cast<int>(codePoint);
+        if (codePoint < 0x0152 || codePoint > 0x2122)
+            return -1;
+        for (int byte = 0x80; byte < 0xA0; ++byte) {
+            if (windows1252CodePoints[byte] == codePoint)
+                return byte;
+        }
+        return -1;
+    }
+
+    //Checks eight bytes at a time for any with the high bit set.
+    static bool isASCII(const std::string& str) {
+        const char * data = str.data();
+        size_t length = str.length();
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            if ((word & UINT64_C(0x8080808080808080)) != 0)
+                return false;
         }
-        catch (boost::locale::conv::conversion_error& /*e*/) {
-            throw error(LIBLO_WARN_BAD_FILENAME, "\"" + str + "\" cannot be encoded in Windows-1252.");
+        for (; i < length; ++i) {
+            if ((data[i] & 0x80) != 0)
+                return false;
         }
+        return true;
+    }
+
+    static error unencodableError(const std::string& str) {
+        return error(LIBLO_WARN_BAD_FILENAME, "\"" + str + "\" cannot be encoded in Windows-1252.");
+    }
+
+    std::string ToUTF8(const std::string& str) {
+        if (isASCII(str))
+            return str;
+
+        std::string utf8;
+        utf8.reserve(str.length() * 2);
+        for (char c : str) {
+            uint8_t byte = static_cast<uint8_t>(c);
+            uint32_t codePoint = windows1252CodePoints[byte];
+            if (byte < 0x80)
+                utf8 += c;
+            else if (codePoint == 0)
+                throw unencodableError(str);
+            else if (codePoint < 0x800) {
+                utf8 += static_cast<char>(0xC0 | (codePoint >> 6));
+                utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else {
+                utf8 += static_cast<char>(0xE0 | (codePoint >> 12));
+                utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+        return utf8;
+    }
+
+    std::string FromUTF8(const std::string& str) {
+        if (isASCII(str))
+            return str;
+
+        std::string windows1252;
+        windows1252.reserve(str.length());
+        size_t i = 0;
+        while (i < str.length()) {
+            uint8_t lead = static_cast<uint8_t>(str[i]);
+            if (lead < 0x80) {
+                windows1252 += str[i++];
+                continue;
+            }
+
+            //Only two and three byte sequences can encode a Windows-1252
+            //character. Anything else, including invalid UTF-8, can't.
+            size_t length;
+            uint32_t codePoint;
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                length = 2;
+                codePoint = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF) {
+                length = 3;
+                codePoint = lead & 0x0F;
+            }
+            else
+                throw unencodableError(str);
+
+            if (i + length > str.length())
+                throw unencodableError(str);
+            for (size_t j = 1; j < length; ++j) {
+                uint8_t trail = static_cast<uint8_t>(str[i + j]);
+                if ((trail & 0xC0) != 0x80)
+                    throw unencodableError(str);
+                codePoint = (codePoint << 6) | (trail & 0x3F);
+            }
+            if (length == 3 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF)))
+                throw unencodableError(str);
+
+            int byte = windows1252Byte(codePoint);
+            if (byte < 0)
+                throw unencodableError(str);
+            windows1252 += static_cast<char>(byte);
+            i += length;
+        }
+        return windows1252;
+    }
+
+    string FoldCase(const string& str) {
+        string folded(str.length(), '\0');
+        casefold::Fold(str.data(), &folded[0], str.length());
+        return folded;
+    }
+
+    bool FoldedEquals(boost::string_ref lhs, boost::string_ref rhs) {
+        return lhs.length() == rhs.length() && casefold::Equals(lhs.data(), rhs.data(), lhs.length());
+    }
+
+    bool FoldedEndsWith(boost::string_ref str, boost::string_ref suffix) {
+        return casefold::EndsWith(str.data(), str.length(), suffix.data(), suffix.length());
+    }
+
+    uint64_t FoldedHash(boost::string_ref str) {
+        return casefold::Hash(str.data(), str.length());
     }
 }
@@ -26,19 +26,151 @@
 #ifndef __LIBLO_HELPERS_H__
 #define __LIBLO_HELPERS_H__
 
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
+#include <boost/utility/string_ref.hpp>
 
 namespace liblo {
     // std::string to null-terminated char string converter.
     char * ToNewCString(const std::string& str);
 
-    //Reads an entire file into a string buffer.
+    //An array of strings output through the API, packed into one buffer so
+    //that reusing it between calls only allocates when a list outgrows
+    //every list stored in it before.
+    class StringArrayBuffer {
+    public:
+        void clear();
+        void push_back(const std::string& str);
+
+        char ** data();  //Null if the array is empty.
+        size_t size() const;
+    private:
+        std::vector<char> buffer;
+        std::vector<size_t> offsets;
+        std::vector<char*> pointers;
+    };
+
+    //Packs the names of a range of plugins one after another, each
+    //null-terminated, into a caller's buffer. Nothing is written unless the
+    //buffer can hold every name. Returns the size that the names need.
+    template<class PluginRange>
+    size_t PackPluginNames(const PluginRange& plugins, char * buffer, size_t bufferSize) {
+        size_t requiredSize = 0;
+        for (const auto& plugin : plugins)
+            requiredSize += plugin.Name().length() + 1;
+
+        if (buffer == nullptr || requiredSize > bufferSize)
+            return requiredSize;
+
+        for (const auto& plugin : plugins) {
+            const std::string& name = plugin.Name();
+            memcpy(buffer, name.c_str(), name.length() + 1);
+            buffer += name.length() + 1;
+        }
+
+        return requiredSize;
+    }
+
+    //Reads an entire file into a string buffer, replacing its contents. The
+    //buffer is left empty if the file can't be opened. As with a text
+    //stream, CRLF line endings are read as LF on Windows.
     void fileToBuffer(const boost::filesystem::path& file, std::string& buffer);
 
+    //Calls function(line) for each line of a buffer, where line is a
+    //boost::string_ref into the buffer without its '\n' or any trailing '\r'.
+    //Blank lines and '#' comment lines, as found in loadorder.txt and
+    //plugins.txt, are skipped.
+    template<class Function>
+    void ForEachLine(const std::string& buffer, Function function) {
+        const char * position = buffer.data();
+        const char * const end = position + buffer.length();
+        while (position < end) {
+            const char * lineEnd = static_cast<const char*>(memchr(position, '\n', end - position));
+            if (lineEnd == nullptr)
+                lineEnd = end;
+
+            boost::string_ref line(position, lineEnd - position);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (!line.empty() && line.front() != '#')
+                function(line);
+
+            position = lineEnd + 1;
+        }
+    }
+
+    //Replaces a file's contents with a buffer by writing a temporary file
+    //beside it and renaming that over it, so readers never see a partial
+    //write. The durability is one of the LIBLO_DURABILITY_* codes. As with
+    //a text stream, newlines are written as CRLF on Windows.
+    void bufferToFile(const boost::filesystem::path& file, const std::string& buffer, unsigned int durability);
+
+    //A key=value setting read from INI text. Settings before the first
+    //section header are in the unnamed section, "". The section, key and
+    //value are views into the text, without surrounding whitespace.
+    struct IniSetting {
+        boost::string_ref section;
+        boost::string_ref key;
+        boost::string_ref value;
+    };
+
+    inline boost::string_ref TrimWhitespace(boost::string_ref str) {
+        while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+            str.remove_prefix(1);
+        while (!str.empty() && (str.back() == ' ' || str.back() == '\t' || str.back() == '\r'))
+            str.remove_suffix(1);
+        return str;
+    }
+
+    //Calls function(setting) for each setting in a buffer of INI text, in one
+    //forward scan that stops once the function returns false. Blank lines,
+    //';' comments and lines without a '=' are skipped. Section and key names
+    //are as written, so should be compared with FoldedEquals.
+    template<class Function>
+    void ScanIni(const std::string& buffer, Function function) {
+        IniSetting setting;
+        const char * position = buffer.data();
+        const char * const end = position + buffer.length();
+        while (position < end) {
+            const char * lineEnd = static_cast<const char*>(memchr(position, '\n', end - position));
+            if (lineEnd == nullptr)
+                lineEnd = end;
+
+            boost::string_ref line = TrimWhitespace(boost::string_ref(position, lineEnd - position));
+            position = lineEnd + 1;
+            if (line.empty() || line.front() == ';')
+                continue;
+
+            if (line.front() == '[') {
+                size_t close = line.find(']');
+                if (close != boost::string_ref::npos)
+                    setting.section = TrimWhitespace(line.substr(1, close - 1));
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == boost::string_ref::npos)
+                continue;
+
+            setting.key = TrimWhitespace(line.substr(0, equals));
+            setting.value = TrimWhitespace(line.substr(equals + 1));
+            if (!function(setting))
+                return;
+        }
+    }
+
     //Only ever have to convert between UTF-8 and Windows-1252.
     std::string ToUTF8(const std::string& str);
     std::string FromUTF8(const std::string& str);
+
+    //Plugin names are compared case-insensitively, folding ASCII letters only.
+    std::string FoldCase(const std::string& str);
+    bool FoldedEquals(boost::string_ref lhs, boost::string_ref rhs);
+    bool FoldedEndsWith(boost::string_ref str, boost::string_ref suffix);
+    uint64_t FoldedHash(boost::string_ref str);  //Not stable across builds, so never persisted.
 }
 
 #endif
@@ -0,0 +1,328 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+// Microbenchmarks for libloadorder's internal hot paths, each run against
+// the code it replaced. Built when PROJECT_BENCHMARKS is on. Run from any
+// directory; the timings are printed to stdout.
+
+#include "backend/CaseFolding.h"
+#include "backend/helpers.h"
+#include "libloadorder/constants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/functional/hash.hpp>
+
+using namespace std;
+using namespace liblo;
+
+namespace {
+    // Stops results from being optimised away.
+    volatile uint64_t sink;
+
+    // Runs a test repeatedly for roughly a quarter of a second, and returns
+    // the mean time per run in nanoseconds.
+    double Time(const function<uint64_t()>& test) {
+        const auto budget = chrono::milliseconds(250);
+        size_t runs = 0;
+        uint64_t result = 0;
+        auto start = chrono::steady_clock::now();
+        auto elapsed = chrono::steady_clock::duration::zero();
+        do {
+            for (size_t i = 0; i < 16; ++i)
+                result += test();
+            runs += 16;
+            elapsed = chrono::steady_clock::now() - start;
+        } while (elapsed < budget);
+        sink = result;
+        return chrono::duration<double, nano>(elapsed).count() / runs;
+    }
+
+    void Compare(const char * name, const function<uint64_t()>& baseline, const function<uint64_t()>& candidate) {
+        double before = Time(baseline);
+        double after = Time(candidate);
+        printf("%-40s %12.0f ns %12.0f ns %8.2fx\n", name, before, after, before / after);
+    }
+
+    // Names shaped like those in real load orders, in a mix of cases.
+    vector<string> PluginNames() {
+        const char * stems[] = {
+            "Skyrim", "Update", "Dawnguard", "HearthFires", "Dragonborn",
+            "Unofficial Skyrim Legendary Edition Patch", "SkyUI", "RaceMenu",
+            "Immersive Armors", "Alternate Start - Live Another Life",
+            "Static Mesh Improvement Mod", "Bashed Patch, 0",
+        };
+        const char * extensions[] = { ".esm", ".esp", ".ESP", ".Esm" };
+
+        vector<string> names;
+        for (size_t i = 0; i < 2048; ++i) {
+            string name = stems[i % 12];
+            if (i >= 12)
+                name += " " + to_string(i);
+            if (i % 3 == 1)
+                name = boost::to_upper_copy(name);
+            names.push_back(name + extensions[i % 4]);
+        }
+        return names;
+    }
+
+    // An INI file with numbered settings in numbered sections, and the given
+    // text at the end of one of them.
+    string IniFile(size_t sections, size_t settingsPerSection, size_t findIn, const string& toFind) {
+        string ini;
+        for (size_t i = 0; i < sections; ++i) {
+            ini += "[Section " + to_string(i) + "]\r\n";
+            for (size_t j = 0; j < settingsPerSection; ++j)
+                ini += "sSetting" + to_string(j) + "=Some value " + to_string(i * j) + "\r\n";
+            if (i == findIn)
+                ini += toFind;
+            ini += "\r\n";
+        }
+        return ini;
+    }
+
+    // How plugin lists were read before they were read in one go.
+    vector<string> ReadLinesByStream(const boost::filesystem::path& file) {
+        vector<string> lines;
+        boost::filesystem::ifstream in(file);
+        string line;
+        while (getline(in, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty() && line[0] != '#')
+                lines.push_back(line);
+        }
+        return lines;
+    }
+
+    string ReadFileByCharacter(const boost::filesystem::path& file) {
+        string buffer;
+        boost::filesystem::ifstream in(file);
+        in.unsetf(ios::skipws);
+        copy(istream_iterator<char>(in), istream_iterator<char>(), back_inserter(buffer));
+        return buffer;
+    }
+}
+
+int main() {
+    vector<string> names = PluginNames();
+    vector<string> upperNames;
+    for (const auto& name : names)
+        upperNames.push_back(boost::to_upper_copy(name));
+
+    printf("%-40s %15s %15s %9s\n", "benchmark (2048 names)", "before", "after", "speedup");
+
+    Compare("Case-insensitive equality",
+        [&]() {
+            uint64_t equal = 0;
+            for (size_t i = 0; i < names.size(); ++i)
+                equal += boost::iequals(names[i], upperNames[i]);
+            return equal;
+        },
+        [&]() {
+            uint64_t equal = 0;
+            for (size_t i = 0; i < names.size(); ++i)
+                equal += FoldedEquals(names[i], upperNames[i]);
+            return equal;
+        });
+
+    Compare("Case-insensitive inequality",
+        [&]() {
+            uint64_t equal = 0;
+            for (size_t i = 1; i < names.size(); ++i)
+                equal += boost::iequals(names[i - 1], upperNames[i]);
+            return equal;
+        },
+        [&]() {
+            uint64_t equal = 0;
+            for (size_t i = 1; i < names.size(); ++i)
+                equal += FoldedEquals(names[i - 1], upperNames[i]);
+            return equal;
+        });
+
+    Compare("Folding to lowercase",
+        [&]() {
+            uint64_t length = 0;
+            for (const auto& name : names)
+                length += boost::to_lower_copy(name).length();
+            return length;
+        },
+        [&]() {
+            uint64_t length = 0;
+            for (const auto& name : names)
+                length += FoldCase(name).length();
+            return length;
+        });
+
+    Compare("Folding in place",
+        [&]() {
+            uint64_t first = 0;
+            for (auto& name : upperNames) {
+                boost::to_lower(name);
+                first += name[0];
+            }
+            return first;
+        },
+        [&]() {
+            uint64_t first = 0;
+            for (auto& name : upperNames) {
+                casefold::Fold(name.data(), &name[0], name.length());
+                first += name[0];
+            }
+            return first;
+        });
+
+    Compare("Case-insensitive hashing",
+        [&]() {
+            uint64_t hashes = 0;
+            for (const auto& name : names)
+                hashes ^= boost::hash<string>()(boost::to_lower_copy(name));
+            return hashes;
+        },
+        [&]() {
+            uint64_t hashes = 0;
+            for (const auto& name : names)
+                hashes ^= FoldedHash(name);
+            return hashes;
+        });
+
+    Compare("Plugin extension check",
+        [&]() {
+            uint64_t plugins = 0;
+            for (const auto& name : names)
+                plugins += boost::iends_with(name, ".esm") || boost::iends_with(name, ".esp");
+            return plugins;
+        },
+        [&]() {
+            uint64_t plugins = 0;
+            for (const auto& name : names)
+                plugins += FoldedEndsWith(name, ".esm") || FoldedEndsWith(name, ".esp");
+            return plugins;
+        });
+
+    // A plugins.txt ten times the length of the longest load order allowed.
+    boost::filesystem::path pluginsFile = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    string pluginsContents = "# This file is used by the game to keep track of your downloaded content.\r\n";
+    for (size_t i = 0; i < 5000; ++i)
+        pluginsContents += names[i % names.size()] + "\r\n";
+    bufferToFile(pluginsFile, pluginsContents, LIBLO_DURABILITY_NONE);
+
+    printf("\n%-40s %15s %15s %9s\n", "benchmark (5000 lines)", "before", "after", "speedup");
+
+    Compare("Reading a file",
+        [&]() {
+            return ReadFileByCharacter(pluginsFile).length();
+        },
+        [&]() {
+            string buffer;
+            fileToBuffer(pluginsFile, buffer);
+            return buffer.length();
+        });
+
+    Compare("Reading a plugin list",
+        [&]() {
+            return ReadLinesByStream(pluginsFile).size();
+        },
+        [&]() {
+            string buffer;
+            fileToBuffer(pluginsFile, buffer);
+            vector<string> lines;
+            ForEachLine(buffer, [&](boost::string_ref line) {
+                lines.emplace_back(line.begin(), line.end());
+            });
+            return lines.size();
+        });
+
+    Compare("Scanning a plugin list's lines",
+        [&]() {
+            return ReadLinesByStream(pluginsFile).size();
+        },
+        [&]() {
+            string buffer;
+            fileToBuffer(pluginsFile, buffer);
+            uint64_t lines = 0;
+            ForEachLine(buffer, [&](boost::string_ref) { ++lines; });
+            return lines;
+        });
+
+    boost::filesystem::remove(pluginsFile);
+
+    // A Morrowind.ini with a full [Game Files] section near its end, and an
+    // Oblivion.ini with bUseMyGamesDirectory in [General], its first section.
+    string gameFiles = "[Game Files]\r\n";
+    for (size_t i = 0; i < 255; ++i)
+        gameFiles += "GameFile" + to_string(i) + "=" + names[i] + "\r\n";
+    string morrowindIni = IniFile(20, 30, 20, "") + gameFiles + IniFile(1, 10, 1, "");
+    string oblivionIni = IniFile(30, 30, 0, "bUseMyGamesDirectory=1\r\n");
+
+    printf("\n%-40s %15s %15s %9s\n", "benchmark (INI files)", "before", "after", "speedup");
+
+    Compare("Reading Morrowind.ini's GameFiles",
+        [&]() {
+            regex reg = regex("GameFile[0-9]{1,3}=.+\\.es(m|p)", regex::ECMAScript | regex::icase);
+            uint64_t plugins = 0;
+            ForEachLine(morrowindIni, [&](boost::string_ref line) {
+                plugins += regex_match(line.begin(), line.end(), reg);
+            });
+            return plugins;
+        },
+        [&]() {
+            uint64_t plugins = 0;
+            ScanIni(morrowindIni, [&](const IniSetting& setting) {
+                if (!FoldedEquals(setting.section, "Game Files"))
+                    return plugins == 0;
+                plugins += FoldedEquals(setting.key.substr(0, 8), "GameFile")
+                    && (FoldedEndsWith(setting.value, ".esm") || FoldedEndsWith(setting.value, ".esp"));
+                return true;
+            });
+            return plugins;
+        });
+
+    Compare("Finding Oblivion.ini's bUseMyGamesDirectory",
+        [&]() {
+            return oblivionIni.find("bUseMyGamesDirectory=");
+        },
+        [&]() {
+            uint64_t value = 0;
+            ScanIni(oblivionIni, [&](const IniSetting& setting) {
+                if (!FoldedEquals(setting.key, "bUseMyGamesDirectory"))
+                    return true;
+                value = setting.value.front();
+                return false;
+            });
+            return value;
+        });
+
+    return 0;
+}
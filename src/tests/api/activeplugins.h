@@ -41,6 +41,52 @@ TEST_F(OblivionOperationsTest, GetActivePlugins) {
     EXPECT_STREQ("Blank.esm", plugins[0]);
 }
 
+TEST_F(OblivionOperationsTest, GetActivePlugins_ReusesOutputBuffer) {
+    char ** plugins = {0};
+    size_t numPlugins = 0;
+
+    unsigned int ret = lo_get_active_plugins(gh, &plugins, &numPlugins);
+    ASSERT_NE(0, numPlugins);
+    const char * first = plugins[0];
+    const std::string firstName(first);
+
+    ASSERT_EQ(ret, lo_get_active_plugins(gh, &plugins, &numPlugins));
+    ASSERT_NE(0, numPlugins);
+    EXPECT_EQ(first, plugins[0]);
+    EXPECT_EQ(firstName, plugins[0]);
+}
+
+TEST_F(OblivionOperationsTest, CopyActivePlugins) {
+    size_t requiredSize = 0;
+    size_t numPlugins = 0;
+
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_active_plugins(NULL, NULL, 0, &requiredSize, &numPlugins));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_active_plugins(gh, NULL, 0, NULL, &numPlugins));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_active_plugins(gh, NULL, 0, &requiredSize, NULL));
+
+    char ** plugins = {0};
+    size_t expectedNum = 0;
+    unsigned int ret = lo_get_active_plugins(gh, &plugins, &expectedNum);
+    ASSERT_NE(0, expectedNum);
+
+    EXPECT_EQ(ret, lo_copy_active_plugins(gh, NULL, 0, &requiredSize, &numPlugins));
+    EXPECT_EQ(expectedNum, numPlugins);
+
+    std::vector<char> buffer(requiredSize, 'x');
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_active_plugins(gh, buffer.data(), requiredSize - 1, &requiredSize, &numPlugins));
+    EXPECT_EQ(std::vector<char>(requiredSize, 'x'), buffer);
+
+    EXPECT_EQ(ret, lo_copy_active_plugins(gh, buffer.data(), buffer.size(), &requiredSize, &numPlugins));
+    EXPECT_EQ(buffer.size(), requiredSize);
+
+    const char * name = buffer.data();
+    for (size_t i = 0; i < expectedNum; ++i) {
+        EXPECT_STREQ(plugins[i], name);
+        name += strlen(name) + 1;
+    }
+    EXPECT_EQ(buffer.data() + buffer.size(), name);
+}
+
 TEST_F(SkyrimOperationsTest, GetActivePlugins) {
     char ** plugins = {0};
     size_t numPlugins = 0;
@@ -247,4 +293,26 @@ TEST_F(SkyrimOperationsTest, SetPluginActive) {
     EXPECT_FALSE(CheckPluginActive("Blank.esm"));
 }
 
+TEST_F(OblivionOperationsTest, SetPluginActiveShouldUpdateTheActivePluginsListWhenWatchingChanges) {
+    const char * initialPlugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+
+    // The handle's own saves don't cause a reload, so the list must be
+    // updated in place.
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_WATCH_CHANGES, 1));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, initialPlugins, 2));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank - Master Dependent.esp", true));
+    ASSERT_EQ(LIBLO_OK, lo_get_active_plugins(gh, &plugins, &numPlugins));
+    EXPECT_EQ(std::vector<std::string>({ "Blank.esm", "Blank.esp", "Blank - Master Dependent.esp" }), std::vector<std::string>(plugins, plugins + numPlugins));
+
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank.esp", false));
+    ASSERT_EQ(LIBLO_OK, lo_get_active_plugins(gh, &plugins, &numPlugins));
+    EXPECT_EQ(std::vector<std::string>({ "Blank.esm", "Blank - Master Dependent.esp" }), std::vector<std::string>(plugins, plugins + numPlugins));
+}
+
 #endif
@@ -1,4 +1,4 @@
-/*  libloadorder
+﻿/*  libloadorder
 
 A library for reading and writing the load order of plugin files for
 TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
@@ -28,6 +28,9 @@ along with libloadorder.  If not, see
 
 #include "tests/fixtures.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <boost/algorithm/string.hpp>
 
 TEST(GetVersion, HandlesNullInput) {
@@ -73,6 +76,27 @@ TEST(GetErrorMessage, HandlesInputCorrectly) {
     ASSERT_STREQ("Null pointer passed.", error);
 }
 
+TEST(GetErrorMessage, IsKeptPerThread) {
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_get_error_message(NULL));
+
+    std::thread other([]() {
+        const char * error = nullptr;
+        EXPECT_EQ(LIBLO_OK, lo_get_error_message(&error));
+        EXPECT_EQ(nullptr, error);
+
+        lo_game_handle gh = nullptr;
+        EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_create_handle(&gh, LIBLO_GAME_TES4, "./missing", NULL));
+        EXPECT_EQ(LIBLO_OK, lo_get_error_message(&error));
+        EXPECT_STREQ("Given game path \"./missing\" is not a valid directory.", error);
+        lo_cleanup();
+    });
+    other.join();
+
+    const char * error = nullptr;
+    EXPECT_EQ(LIBLO_OK, lo_get_error_message(&error));
+    EXPECT_STREQ("Null pointer passed.", error);
+}
+
 TEST(Cleanup, CleansUpAfterError) {
     // First generate an error.
     EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_get_error_message(NULL));
@@ -190,6 +214,264 @@ TEST_F(SkyrimOperationsTest, SetGameMaster) {
     EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_game_master(gh, "EnhancedWeather.missing.esm"));
 }
 
+TEST_F(OblivionOperationsTest, SetHandleOption) {
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_handle_option(NULL, LIBLO_OPTION_HEADER_CACHE, 1));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_handle_option(gh, UINT_MAX, 1));
+
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_HEADER_CACHE, 0));
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_HEADER_CACHE, 1));
+
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_handle_option(gh, LIBLO_OPTION_WORKER_THREADS, 65));
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_WORKER_THREADS, 4));
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_WORKER_THREADS, 0));
+
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_handle_option(gh, LIBLO_OPTION_SAVE_DURABILITY, 3));
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_SAVE_DURABILITY, LIBLO_DURABILITY_FOLDER));
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_SAVE_DURABILITY, LIBLO_DURABILITY_NONE));
+}
+
+TEST_F(OblivionOperationsTest, WorkerThreadsGiveSameLoadOrder) {
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    std::vector<std::string> expected(plugins, plugins + numPlugins);
+
+    lo_game_handle threadedGh = nullptr;
+    ASSERT_EQ(LIBLO_OK, lo_create_handle(&threadedGh, LIBLO_GAME_TES4, dataPath.parent_path().string().c_str(), localPath.string().c_str()));
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(threadedGh, LIBLO_OPTION_WORKER_THREADS, 4));
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(threadedGh, "Blank.esm"));
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(threadedGh, &plugins, &numPlugins));
+    EXPECT_EQ(expected, std::vector<std::string>(plugins, plugins + numPlugins));
+    lo_destroy_handle(threadedGh);
+}
+
+TEST_F(OblivionOperationsTest, WatchChangesSeesNewPlugins) {
+#ifdef __linux__
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_WATCH_CHANGES, 1));
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    size_t initialCount = numPlugins;
+
+    // An unchanged install should give the same load order.
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    EXPECT_EQ(initialCount, numPlugins);
+
+    ASSERT_NO_THROW(boost::filesystem::copy_file(dataPath / "Blank.esp", dataPath / "Blank - Copy.esp"));
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    EXPECT_EQ(initialCount + 1, numPlugins);
+    EXPECT_NE(plugins + numPlugins, std::find(plugins, plugins + numPlugins, std::string("Blank - Copy.esp")));
+
+    ASSERT_NO_THROW(boost::filesystem::remove(dataPath / "Blank - Copy.esp"));
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    EXPECT_EQ(initialCount, numPlugins);
+
+    EXPECT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_WATCH_CHANGES, 0));
+#else
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_handle_option(gh, LIBLO_OPTION_WATCH_CHANGES, 1));
+#endif
+}
+
+TEST_F(OblivionOperationsTest, TimestampChangesAreSeenWithoutWatching) {
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    ASSERT_LT(2, numPlugins);
+    std::string lastPlugin(plugins[numPlugins - 1]);
+
+    // Make the last plugin the earliest-stamped one.
+    ASSERT_NO_THROW(boost::filesystem::last_write_time(dataPath / lastPlugin, 0));
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    EXPECT_NE(lastPlugin, std::string(plugins[numPlugins - 1]));
+}
+
+TEST_F(OblivionOperationsTest, HeaderCacheIsWrittenAndReused) {
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_HEADER_CACHE, 1));
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    std::vector<std::string> expected(plugins, plugins + numPlugins);
+    EXPECT_TRUE(boost::filesystem::exists(localPath / "libloadorder.cache"));
+
+    // A new handle should get the same load order from the cached headers.
+    lo_game_handle cachedGh = nullptr;
+    ASSERT_EQ(LIBLO_OK, lo_create_handle(&cachedGh, LIBLO_GAME_TES4, dataPath.parent_path().string().c_str(), localPath.string().c_str()));
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(cachedGh, LIBLO_OPTION_HEADER_CACHE, 1));
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(cachedGh, "Blank.esm"));
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(cachedGh, &plugins, &numPlugins));
+    EXPECT_EQ(expected, std::vector<std::string>(plugins, plugins + numPlugins));
+    lo_destroy_handle(cachedGh);
+
+    ASSERT_NO_THROW(boost::filesystem::remove(localPath / "libloadorder.cache"));
+}
+
+TEST_F(OblivionOperationsTest, DurableSavesReplaceTheFilesWhole) {
+    const char * plugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_SAVE_DURABILITY, LIBLO_DURABILITY_FOLDER));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, plugins, 2));
+    EXPECT_TRUE(CheckPluginActive("Blank.esm"));
+    EXPECT_TRUE(CheckPluginActive("Blank.esp"));
+
+    // No temporary files should be left behind.
+    for (boost::filesystem::directory_iterator it(localPath); it != boost::filesystem::directory_iterator(); ++it)
+        EXPECT_NE(".tmp", it->path().extension().string());
+}
+
+TEST_F(OblivionOperationsTest, TransactionsMustBeOpenToCommitOrAbort) {
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_begin_transaction(NULL));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_commit_transaction(NULL));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_abort_transaction(NULL));
+
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_commit_transaction(gh));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_abort_transaction(gh));
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_begin_transaction(gh));
+    EXPECT_EQ(LIBLO_OK, lo_commit_transaction(gh));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_commit_transaction(gh));
+}
+
+TEST_F(OblivionOperationsTest, TransactionChangesAreSavedOnCommit) {
+    const char * plugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, plugins, 2));
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank - Master Dependent.esp", true));
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank.esp", false));
+
+    // The changes can be read back, but haven't been written.
+    bool isActive = false;
+    EXPECT_EQ(LIBLO_OK, lo_get_plugin_active(gh, "Blank - Master Dependent.esp", &isActive));
+    EXPECT_TRUE(isActive);
+    AssertInitialState();
+
+    ASSERT_EQ(LIBLO_OK, lo_commit_transaction(gh));
+    EXPECT_TRUE(CheckPluginActive("Blank.esm"));
+    EXPECT_TRUE(CheckPluginActive("Blank - Master Dependent.esp"));
+    EXPECT_FALSE(CheckPluginActive("Blank.esp"));
+}
+
+TEST_F(OblivionOperationsTest, AbortedTransactionChangesAreDiscarded) {
+    const char * plugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, plugins, 2));
+    ASSERT_EQ(LIBLO_OK, lo_abort_transaction(gh));
+
+    // The initial plugins.txt lists invalid plugins, so may give a warning.
+    bool isActive = true;
+    EXPECT_PRED1([](unsigned int i) {
+        return i == LIBLO_OK || i == LIBLO_WARN_INVALID_LIST;
+    }, lo_get_plugin_active(gh, "Blank.esp", &isActive));
+    EXPECT_FALSE(isActive);
+    AssertInitialState();
+}
+
+TEST_F(OblivionOperationsTest, TransactionChangesAreListedUntilAborted) {
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    lo_get_active_plugins(gh, &plugins, &numPlugins);
+    const std::vector<std::string> initialPlugins(plugins, plugins + numPlugins);
+    ASSERT_EQ(initialPlugins.end(), std::find(initialPlugins.begin(), initialPlugins.end(), "Blank - Master Dependent.esp"));
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank - Master Dependent.esp", true));
+
+    std::vector<std::string> expected(initialPlugins);
+    expected.push_back("Blank - Master Dependent.esp");
+    lo_get_active_plugins(gh, &plugins, &numPlugins);
+    EXPECT_EQ(expected, std::vector<std::string>(plugins, plugins + numPlugins));
+
+    ASSERT_EQ(LIBLO_OK, lo_abort_transaction(gh));
+    lo_get_active_plugins(gh, &plugins, &numPlugins);
+    EXPECT_EQ(initialPlugins, std::vector<std::string>(plugins, plugins + numPlugins));
+}
+
+TEST_F(OblivionOperationsTest, FailedChangesInATransactionAreUndone) {
+    const char * plugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+    const char * duplicatePlugins[] = {
+        "Blank.esm",
+        "Blank.esm"
+    };
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, plugins, 2));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_active_plugins(gh, duplicatePlugins, 2));
+
+    bool isActive = false;
+    EXPECT_EQ(LIBLO_OK, lo_get_plugin_active(gh, "Blank.esp", &isActive));
+    EXPECT_TRUE(isActive);
+
+    ASSERT_EQ(LIBLO_OK, lo_commit_transaction(gh));
+    EXPECT_TRUE(CheckPluginActive("Blank.esp"));
+}
+
+TEST_F(OblivionOperationsTest, FailedLoadOrderChangesInATransactionKeepEarlierActivations) {
+    const char * activePlugins[] = {
+        "Blank.esm",
+        "Blank.esp"
+    };
+    const char * duplicatePlugins[] = {
+        "Blank.esm",
+        "Blank.esm"
+    };
+
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, activePlugins, 2));
+    ASSERT_EQ(LIBLO_OK, lo_set_plugin_active(gh, "Blank - Master Dependent.esp", true));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    const std::vector<std::string> loadOrder(plugins, plugins + numPlugins);
+
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_set_load_order(gh, duplicatePlugins, 2));
+
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    EXPECT_EQ(loadOrder, std::vector<std::string>(plugins, plugins + numPlugins));
+    bool isActive = false;
+    EXPECT_EQ(LIBLO_OK, lo_get_plugin_active(gh, "Blank - Master Dependent.esp", &isActive));
+    EXPECT_TRUE(isActive);
+
+    ASSERT_EQ(LIBLO_OK, lo_commit_transaction(gh));
+    EXPECT_TRUE(CheckPluginActive("Blank - Master Dependent.esp"));
+}
+
+TEST_F(OblivionOperationsTest, InvalidTransactionsAreNotCommitted) {
+    const char * plugins[] = {
+        "Blank.esm",
+        "NotAPlugin.esm"
+    };
+
+    // Validity is only checked on commit, which leaves the transaction open.
+    ASSERT_EQ(LIBLO_OK, lo_begin_transaction(gh));
+    ASSERT_EQ(LIBLO_OK, lo_set_active_plugins(gh, plugins, 2));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_commit_transaction(gh));
+    AssertInitialState();
+    EXPECT_EQ(LIBLO_OK, lo_abort_transaction(gh));
+}
+
 TEST_F(OblivionOperationsTest, FixPluginLists) {
     EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_fix_plugin_lists(NULL));
     AssertInitialState();
@@ -28,6 +28,9 @@ along with libloadorder.  If not, see
 
 #include "tests/fixtures.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <boost/algorithm/string.hpp>
 
 TEST_F(OblivionOperationsTest, GetLoadOrderMethod) {
@@ -164,6 +167,39 @@ TEST_F(OblivionOperationsTest, SetLoadOrder_Valid) {
     EXPECT_EQ(1, CheckPluginPosition("Blank - Different.esm"));
 }
 
+TEST_F(OblivionOperationsTest, SetLoadOrder_TouchesOnlyMovedPlugins) {
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    std::vector<std::string> loadOrder(plugins, plugins + numPlugins);
+
+    // Move a plugin to the end of the load order.
+    auto it = std::find(loadOrder.begin(), loadOrder.end(), "Blank - Master Dependent.esp");
+    ASSERT_NE(loadOrder.end(), it);
+    loadOrder.erase(it);
+    loadOrder.push_back("Blank - Master Dependent.esp");
+    std::vector<const char *> newPlugins;
+    for (const auto& plugin : loadOrder)
+        newPlugins.push_back(plugin.c_str());
+
+    std::map<boost::filesystem::path, time_t> modTimes;
+    for (boost::filesystem::directory_iterator itr(dataPath); itr != boost::filesystem::directory_iterator(); ++itr)
+        modTimes[itr->path()] = boost::filesystem::last_write_time(itr->path());
+
+    ASSERT_EQ(LIBLO_OK, lo_set_load_order(gh, newPlugins.data(), newPlugins.size()));
+    EXPECT_EQ(numPlugins - 1, CheckPluginPosition("Blank - Master Dependent.esp"));
+
+    // Only the moved plugin should have been given a new timestamp.
+    size_t touched = 0;
+    for (const auto& modTime : modTimes) {
+        if (boost::filesystem::last_write_time(modTime.first) != modTime.second)
+            ++touched;
+    }
+    EXPECT_EQ(1, touched);
+}
+
 TEST_F(SkyrimOperationsTest, SetLoadOrder_MissingPlugin) {
     const char * missingPlugins[] = {
         "Skyrim.esm",
@@ -273,6 +309,102 @@ TEST_F(OblivionOperationsTest, GetLoadOrder) {
     EXPECT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &pluginsNum));
 }
 
+TEST_F(OblivionOperationsTest, CopyLoadOrder) {
+    size_t requiredSize = 0;
+    size_t pluginsNum = 0;
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_load_order(NULL, NULL, 0, &requiredSize, &pluginsNum));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_load_order(gh, NULL, 0, NULL, &pluginsNum));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_load_order(gh, NULL, 0, &requiredSize, NULL));
+
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+    ASSERT_EQ(LIBLO_OK, lo_copy_load_order(gh, NULL, 0, &requiredSize, &pluginsNum));
+
+    char ** plugins = {0};
+    size_t expectedNum = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &expectedNum));
+    EXPECT_EQ(expectedNum, pluginsNum);
+
+    std::vector<char> buffer(requiredSize, 'x');
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_copy_load_order(gh, buffer.data(), requiredSize - 1, &requiredSize, &pluginsNum));
+    EXPECT_EQ(std::vector<char>(requiredSize, 'x'), buffer);
+
+    ASSERT_EQ(LIBLO_OK, lo_copy_load_order(gh, buffer.data(), buffer.size(), &requiredSize, &pluginsNum));
+    EXPECT_EQ(buffer.size(), requiredSize);
+
+    const char * name = buffer.data();
+    for (size_t i = 0; i < expectedNum; ++i) {
+        EXPECT_STREQ(plugins[i], name);
+        name += strlen(name) + 1;
+    }
+    EXPECT_EQ(buffer.data() + buffer.size(), name);
+}
+
+struct ForEachPluginResult {
+    std::vector<std::string> names;
+    std::vector<size_t> positions;
+    std::vector<bool> active;
+    std::vector<bool> masters;
+    size_t limit = std::numeric_limits<size_t>::max();
+};
+
+static bool collectPlugin(const char * name, size_t position, bool active, bool master, void * userdata) {
+    ForEachPluginResult * result = static_cast<ForEachPluginResult*>(userdata);
+    result->names.push_back(name);
+    result->positions.push_back(position);
+    result->active.push_back(active);
+    result->masters.push_back(master);
+    return result->names.size() < result->limit;
+}
+
+TEST_F(OblivionOperationsTest, ForEachPlugin) {
+    ForEachPluginResult result;
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_for_each_plugin(NULL, 0, collectPlugin, &result));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_for_each_plugin(gh, 0, NULL, &result));
+    EXPECT_EQ(LIBLO_ERROR_INVALID_ARGS, lo_for_each_plugin(gh, 4, collectPlugin, &result));
+    EXPECT_TRUE(result.names.empty());
+
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+    char ** plugins = {0};
+    size_t pluginsNum = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &pluginsNum));
+
+    lo_for_each_plugin(gh, 0, collectPlugin, &result);
+    ASSERT_EQ(pluginsNum, result.names.size());
+    for (size_t i = 0; i < pluginsNum; ++i) {
+        EXPECT_EQ(plugins[i], result.names[i]);
+        EXPECT_EQ(i, result.positions[i]);
+
+        bool active = false;
+        lo_get_plugin_active(gh, plugins[i], &active);
+        EXPECT_EQ(active, result.active[i]);
+    }
+    EXPECT_TRUE(result.masters[0]);
+    EXPECT_FALSE(result.masters.back());
+}
+
+TEST_F(OblivionOperationsTest, ForEachPlugin_Filtered) {
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    ForEachPluginResult all;
+    lo_for_each_plugin(gh, 0, collectPlugin, &all);
+
+    ForEachPluginResult masters;
+    lo_for_each_plugin(gh, LIBLO_FOR_EACH_MASTERS_ONLY, collectPlugin, &masters);
+    EXPECT_EQ(std::count(all.masters.begin(), all.masters.end(), true), masters.names.size());
+    EXPECT_EQ(std::vector<bool>(masters.names.size(), true), masters.masters);
+
+    ForEachPluginResult active;
+    lo_for_each_plugin(gh, LIBLO_FOR_EACH_ACTIVE_ONLY, collectPlugin, &active);
+    EXPECT_EQ(std::count(all.active.begin(), all.active.end(), true), active.names.size());
+    EXPECT_EQ(std::vector<bool>(active.names.size(), true), active.active);
+
+    ForEachPluginResult first;
+    first.limit = 1;
+    lo_for_each_plugin(gh, 0, collectPlugin, &first);
+    ASSERT_EQ(1, first.names.size());
+    EXPECT_EQ(all.names[0], first.names[0]);
+}
+
 TEST_F(SkyrimOperationsTest, GetLoadOrder) {
     char ** plugins = {0};
     size_t pluginsNum;
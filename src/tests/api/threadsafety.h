@@ -0,0 +1,103 @@
+/*  libloadorder
+
+A library for reading and writing the load order of plugin files for
+TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+Fallout: New Vegas.
+
+Copyright (C) 2012    WrinklyNinja
+
+This file is part of libloadorder.
+
+libloadorder is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of
+the License, or (at your option) any later version.
+
+libloadorder is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with libloadorder.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __LIBLO_TEST_API_THREAD_SAFETY__
+#define __LIBLO_TEST_API_THREAD_SAFETY__
+
+#include "tests/fixtures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
+static bool checkPluginCallback(const char * name, size_t /*position*/, bool /*active*/, bool /*master*/, void * userdata) {
+    const std::set<std::string> * names = static_cast<const std::set<std::string>*>(userdata);
+    EXPECT_EQ(1, names->count(name));
+    return true;
+}
+
+TEST_F(OblivionOperationsTest, ThreadSafeHandleCanBeReadWhileBeingChanged) {
+    ASSERT_EQ(LIBLO_OK, lo_set_handle_option(gh, LIBLO_OPTION_THREAD_SAFE, 1));
+    ASSERT_EQ(LIBLO_OK, lo_set_game_master(gh, "Blank.esm"));
+
+    char ** plugins = nullptr;
+    size_t numPlugins = 0;
+    ASSERT_EQ(LIBLO_OK, lo_get_load_order(gh, &plugins, &numPlugins));
+    const std::vector<std::string> loadOrder(plugins, plugins + numPlugins);
+    const std::set<std::string> names(loadOrder.begin(), loadOrder.end());
+
+    // The writer alternates between the initial load order and one with a
+    // plugin moved to the end.
+    std::vector<std::string> movedLoadOrder(loadOrder);
+    auto it = std::find(movedLoadOrder.begin(), movedLoadOrder.end(), "Blank - Master Dependent.esp");
+    ASSERT_NE(movedLoadOrder.end(), it);
+    movedLoadOrder.erase(it);
+    movedLoadOrder.push_back("Blank - Master Dependent.esp");
+
+    std::vector<const char *> initialPlugins, movedPlugins;
+    for (const auto& plugin : loadOrder)
+        initialPlugins.push_back(plugin.c_str());
+    for (const auto& plugin : movedLoadOrder)
+        movedPlugins.push_back(plugin.c_str());
+
+    std::atomic<bool> writing(true);
+    std::thread writer([&]() {
+        for (size_t i = 0; i < 50; ++i) {
+            const auto& newPlugins = i % 2 == 0 ? movedPlugins : initialPlugins;
+            EXPECT_EQ(LIBLO_OK, lo_set_load_order(gh, newPlugins.data(), newPlugins.size()));
+        }
+        writing = false;
+    });
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            do {
+                char ** threadPlugins = nullptr;
+                size_t threadNumPlugins = 0;
+                unsigned int ret = lo_get_load_order(gh, &threadPlugins, &threadNumPlugins);
+                EXPECT_TRUE(ret == LIBLO_OK || ret == LIBLO_WARN_INVALID_LIST);
+
+                // This thread's output must not be changed by other threads.
+                std::vector<std::string> threadLoadOrder(threadPlugins, threadPlugins + threadNumPlugins);
+                bool active = false;
+                lo_get_plugin_active(gh, "Blank.esm", &active);
+                lo_for_each_plugin(gh, 0, checkPluginCallback, const_cast<std::set<std::string>*>(&names));
+                EXPECT_EQ(threadLoadOrder, std::vector<std::string>(threadPlugins, threadPlugins + threadNumPlugins));
+
+                EXPECT_EQ(numPlugins, threadNumPlugins);
+                for (const auto& plugin : threadLoadOrder)
+                    EXPECT_EQ(1, names.count(plugin));
+            } while (writing);
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers)
+        reader.join();
+}
+
+#endif
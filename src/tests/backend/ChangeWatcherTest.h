@@ -0,0 +1,122 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+#include <gtest/gtest.h>
+
+#include "backend/ChangeWatcher.h"
+
+#include <boost/filesystem/fstream.hpp>
+
+namespace liblo {
+    namespace test {
+        class ChangeWatcherTest : public ::testing::Test {
+        protected:
+            inline ChangeWatcherTest() :
+                folder(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {}
+
+            inline virtual void SetUp() {
+                ASSERT_TRUE(boost::filesystem::create_directories(folder / "Data"));
+            }
+
+            inline virtual void TearDown() {
+                ASSERT_NO_THROW(boost::filesystem::remove_all(folder));
+            }
+
+            inline void write(const boost::filesystem::path& file) {
+                boost::filesystem::ofstream out(file);
+                out << "content";
+            }
+
+            inline void start() {
+                watcher.Start(folder / "Data", folder / "loadorder.txt", folder / "plugins.txt");
+                watcher.MarkClean(ChangeWatcher::ALL);
+            }
+
+            boost::filesystem::path folder;
+            ChangeWatcher watcher;
+        };
+
+        TEST_F(ChangeWatcherTest, aStoppedWatcherShouldCoverNothingAndAlwaysBeDirty) {
+            EXPECT_FALSE(watcher.Covers(ChangeWatcher::PLUGIN_DATA));
+            EXPECT_TRUE(watcher.IsDirty(ChangeWatcher::ALL));
+
+            watcher.MarkClean(ChangeWatcher::ALL);
+            EXPECT_TRUE(watcher.IsDirty(ChangeWatcher::ALL));
+        }
+
+        TEST_F(ChangeWatcherTest, anUnchangedInstallShouldStayClean) {
+            if (!ChangeWatcher::IsSupported())
+                return;
+
+            start();
+            EXPECT_TRUE(watcher.Covers(ChangeWatcher::ALL));
+            EXPECT_FALSE(watcher.IsDirty(ChangeWatcher::ALL));
+        }
+
+        TEST_F(ChangeWatcherTest, changingThePluginsFolderShouldDirtyPluginDataAndLoadOrder) {
+            if (!ChangeWatcher::IsSupported())
+                return;
+
+            start();
+            write(folder / "Data" / "Blank.esp");
+
+            EXPECT_TRUE(watcher.IsDirty(ChangeWatcher::PLUGIN_DATA));
+            EXPECT_TRUE(watcher.IsDirty(ChangeWatcher::LOAD_ORDER));
+            EXPECT_FALSE(watcher.IsDirty(ChangeWatcher::ACTIVE_PLUGINS));
+        }
+
+        TEST_F(ChangeWatcherTest, onlyTheWatchedFilesInTheirFolderShouldDirtyCaches) {
+            if (!ChangeWatcher::IsSupported())
+                return;
+
+            start();
+            write(folder / "other.txt");
+            EXPECT_FALSE(watcher.IsDirty(ChangeWatcher::ALL));
+
+            write(folder / "plugins.txt");
+            EXPECT_TRUE(watcher.IsDirty(ChangeWatcher::ACTIVE_PLUGINS));
+            EXPECT_FALSE(watcher.IsDirty(ChangeWatcher::PLUGIN_DATA));
+        }
+
+        TEST_F(ChangeWatcherTest, acknowledgingShouldDiscardPendingChanges) {
+            if (!ChangeWatcher::IsSupported())
+                return;
+
+            start();
+            write(folder / "loadorder.txt");
+            watcher.Acknowledge(ChangeWatcher::LOAD_ORDER);
+
+            EXPECT_FALSE(watcher.IsDirty(ChangeWatcher::LOAD_ORDER));
+        }
+
+        TEST_F(ChangeWatcherTest, missingFoldersShouldNotBeCovered) {
+            if (!ChangeWatcher::IsSupported())
+                return;
+
+            watcher.Start(folder / "missing", folder / "loadorder.txt", folder / "plugins.txt");
+            EXPECT_FALSE(watcher.Covers(ChangeWatcher::PLUGIN_DATA));
+            EXPECT_TRUE(watcher.Covers(ChangeWatcher::ACTIVE_PLUGINS));
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+#include <gtest/gtest.h>
+
+#include "backend/DataDirSnapshot.h"
+
+#include <boost/filesystem/fstream.hpp>
+
+namespace liblo {
+    namespace test {
+        class DataDirSnapshotTest : public ::testing::Test {
+        protected:
+            inline DataDirSnapshotTest() :
+                folder(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()) {}
+
+            inline virtual void SetUp() {
+                ASSERT_TRUE(boost::filesystem::create_directory(folder));
+                write("Blank.esm", "abc");
+                write("Blank.esp.ghost", "abcdef");
+                write("Both.esp", "a");
+                write("Both.esp.ghost", "ab");
+                write("notes.txt", "");
+                write("notes.txt.ghost", "");
+                ASSERT_TRUE(boost::filesystem::create_directory(folder / "Folder.esp"));
+            }
+
+            inline virtual void TearDown() {
+                ASSERT_NO_THROW(boost::filesystem::remove_all(folder));
+            }
+
+            inline void write(const std::string& filename, const std::string& content) {
+                boost::filesystem::ofstream out(folder / filename);
+                out << content;
+            }
+
+            boost::filesystem::path folder;
+            DataDirSnapshot snapshot;
+        };
+
+        TEST_F(DataDirSnapshotTest, aNewSnapshotShouldBeInvalid) {
+            EXPECT_FALSE(snapshot.IsValid());
+            EXPECT_EQ(nullptr, snapshot.Find("Blank.esm"));
+        }
+
+        TEST_F(DataDirSnapshotTest, buildingShouldListOnlyPluginFiles) {
+            snapshot.Build(folder);
+
+            EXPECT_TRUE(snapshot.IsValid());
+            EXPECT_TRUE(snapshot.FolderExists());
+            EXPECT_EQ(4, snapshot.Entries().size());
+            EXPECT_EQ(nullptr, snapshot.Find("notes.txt"));
+            EXPECT_EQ(nullptr, snapshot.Find("Folder.esp"));
+        }
+
+        TEST_F(DataDirSnapshotTest, findingShouldBeCaseInsensitiveAndRecordTheRealFilename) {
+            snapshot.Build(folder);
+
+            auto file = snapshot.Find("blank.ESM");
+            ASSERT_NE(nullptr, file);
+            EXPECT_EQ("Blank.esm", file->filename);
+            EXPECT_FALSE(file->ghosted);
+            EXPECT_EQ(3, file->fingerprint.size);
+        }
+
+        TEST_F(DataDirSnapshotTest, findingAGhostedPluginShouldGiveItsGhostFile) {
+            snapshot.Build(folder);
+
+            auto file = snapshot.Find("Blank.esp");
+            ASSERT_NE(nullptr, file);
+            EXPECT_EQ("Blank.esp.ghost", file->filename);
+            EXPECT_TRUE(file->ghosted);
+        }
+
+        TEST_F(DataDirSnapshotTest, anUnghostedPluginShouldTakePrecedenceOverItsGhost) {
+            snapshot.Build(folder);
+
+            auto file = snapshot.Find("Both.esp");
+            ASSERT_NE(nullptr, file);
+            EXPECT_EQ("Both.esp", file->filename);
+            EXPECT_FALSE(file->ghosted);
+        }
+
+        TEST_F(DataDirSnapshotTest, updatesShouldBeVisibleInFind) {
+            snapshot.Build(folder);
+
+            snapshot.SetUnghosted("Blank.esp");
+            snapshot.SetModTime("Blank.esp", 1000);
+
+            auto file = snapshot.Find("Blank.esp");
+            ASSERT_NE(nullptr, file);
+            EXPECT_EQ("Blank.esp", file->filename);
+            EXPECT_FALSE(file->ghosted);
+            EXPECT_EQ(1000, file->fingerprint.mtime);
+        }
+
+        TEST_F(DataDirSnapshotTest, buildingForAMissingFolderShouldGiveAnEmptySnapshot) {
+            snapshot.Build(folder / "missing");
+
+            EXPECT_TRUE(snapshot.IsValid());
+            EXPECT_FALSE(snapshot.FolderExists());
+            EXPECT_TRUE(snapshot.Entries().empty());
+        }
+
+        TEST_F(DataDirSnapshotTest, invalidatingShouldForgetAllFiles) {
+            snapshot.Build(folder);
+            snapshot.Invalidate();
+
+            EXPECT_FALSE(snapshot.IsValid());
+            EXPECT_EQ(nullptr, snapshot.Find("Blank.esm"));
+        }
+    }
+}
@@ -30,6 +30,8 @@ along with libloadorder.  If not, see
 
 #include <libespm/GameId.h>
 
+#include <boost/filesystem/fstream.hpp>
+
 namespace liblo {
     namespace test {
         class GameHandleTest : public ::testing::TestWithParam<unsigned int> {
@@ -73,5 +75,32 @@ namespace liblo {
             else
                 EXPECT_NO_THROW(gameHandle.LoadOrderFile());
         }
+
+        TEST(OblivionGameHandleTest, shouldUseTheGameFolderForListsIfUseMyGamesDirectoryIsOffInGeneral) {
+            boost::filesystem::path iniPath("./Oblivion/Oblivion.ini");
+            boost::filesystem::ofstream out(iniPath);
+            out << "[General]" << std::endl
+                << "SLocalSavePath=Saves\\" << std::endl
+                << "buseMyGamesDirectory = 0" << std::endl
+                << "[Display]" << std::endl
+                << "bUseMyGamesDirectory=1" << std::endl;
+            out.close();
+
+            _lo_game_handle_int gameHandle(LIBLO_GAME_TES4, "./Oblivion");
+            gameHandle.SetLocalAppData("./local/Oblivion");
+            EXPECT_EQ(boost::filesystem::path("./Oblivion/plugins.txt"), gameHandle.ActivePluginsFile());
+
+            out.open(iniPath);
+            out << "[Display]" << std::endl
+                << "bUseMyGamesDirectory=0" << std::endl
+                << "[General]" << std::endl
+                << "bUseMyGamesDirectory=1" << std::endl;
+            out.close();
+
+            gameHandle.SetLocalAppData("./local/Oblivion");
+            EXPECT_EQ(boost::filesystem::path("./local/Oblivion/plugins.txt"), gameHandle.ActivePluginsFile());
+
+            boost::filesystem::remove(iniPath);
+        }
     }
 }
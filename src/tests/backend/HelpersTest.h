@@ -0,0 +1,327 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+#include <gtest/gtest.h>
+
+#include "backend/helpers.h"
+#include "backend/error.h"
+#include "libloadorder/constants.h"
+
+#include <boost/locale.hpp>
+
+namespace liblo {
+    namespace test {
+        // Boost.Locale's converter is the reference for the Windows-1252 codec.
+        static bool referenceToUTF8(const std::string& str, std::string& out) {
+            try {
+                out = boost::locale::conv::to_utf<char>(str, "Windows-1252", boost::locale::conv::stop);
+                return true;
+            }
+            catch (boost::locale::conv::conversion_error&) {
+                return false;
+            }
+        }
+
+        static bool referenceFromUTF8(const std::string& str, std::string& out) {
+            try {
+                out = boost::locale::conv::from_utf<char>(str, "Windows-1252", boost::locale::conv::stop);
+                return true;
+            }
+            catch (boost::locale::conv::conversion_error&) {
+                return false;
+            }
+        }
+
+        static std::string encodeUTF8(uint32_t codePoint) {
+            std::string utf8;
+            if (codePoint < 0x80)
+                utf8 += static_cast<char>(codePoint);
+            else if (codePoint < 0x800) {
+                utf8 += static_cast<char>(0xC0 | (codePoint >> 6));
+                utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000) {
+                utf8 += static_cast<char>(0xE0 | (codePoint >> 12));
+                utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else {
+                utf8 += static_cast<char>(0xF0 | (codePoint >> 18));
+                utf8 += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            return utf8;
+        }
+
+        static void expectBadFilename(std::string (*convert)(const std::string&), const std::string& str) {
+            try {
+                convert(str);
+                ADD_FAILURE() << "No error for a string of length " << str.length();
+            }
+            catch (error& e) {
+                EXPECT_EQ(LIBLO_WARN_BAD_FILENAME, e.code());
+            }
+        }
+
+        TEST(HelpersTest, toUTF8ShouldMatchTheReferenceForEveryByte) {
+            for (unsigned int byte = 1; byte < 256; ++byte) {
+                std::string str("a");
+                str += static_cast<char>(byte);
+
+                std::string expected;
+                if (referenceToUTF8(str, expected)) {
+                    EXPECT_EQ(expected, ToUTF8(str)) << "Byte " << byte;
+                }
+                else
+                    expectBadFilename(ToUTF8, str);
+            }
+        }
+
+        TEST(HelpersTest, fromUTF8ShouldMatchTheReferenceForEveryCodePoint) {
+            for (uint32_t codePoint = 1; codePoint < 0x110000; ++codePoint) {
+                if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+                    continue;
+                if (codePoint > 0x3000 && codePoint < 0x10000 && codePoint % 97 != 0)
+                    continue;  // Sample the rest of the BMP.
+                if (codePoint >= 0x10000 && codePoint % 4099 != 0)
+                    continue;
+
+                std::string str = "a" + encodeUTF8(codePoint) + "b";
+
+                std::string expected;
+                if (referenceFromUTF8(str, expected)) {
+                    EXPECT_EQ(expected, FromUTF8(str)) << "Code point " << codePoint;
+                }
+                else
+                    expectBadFilename(FromUTF8, str);
+            }
+        }
+
+        TEST(HelpersTest, fromUTF8ShouldRejectInvalidUTF8) {
+            expectBadFilename(FromUTF8, "a\xC3");
+            expectBadFilename(FromUTF8, "a\xFFz");
+            expectBadFilename(FromUTF8, "\xE2\x82");
+            expectBadFilename(FromUTF8, "\xE2\x82z");
+            expectBadFilename(FromUTF8, "\xC0\x80");
+            expectBadFilename(FromUTF8, "\xE0\x80\x80");
+            expectBadFilename(FromUTF8, "\xED\xA0\x80");
+            expectBadFilename(FromUTF8, "\x80");
+        }
+
+        TEST(HelpersTest, conversionsShouldRoundTripWindows1252) {
+            std::string str;
+            for (unsigned int byte = 1; byte < 256; ++byte) {
+                if (byte != 0x81 && byte != 0x8D && byte != 0x8F && byte != 0x90 && byte != 0x9D)
+                    str += static_cast<char>(byte);
+            }
+            EXPECT_EQ(str, FromUTF8(ToUTF8(str)));
+        }
+
+        TEST(HelpersTest, conversionsShouldFindNonAsciiBytesAtAnyOffset) {
+            for (size_t length = 1; length < 40; ++length) {
+                for (size_t offset = 0; offset < length; ++offset) {
+                    std::string str(length, 'a');
+                    str[offset] = '\xE9';
+
+                    std::string utf8(str);
+                    utf8.replace(offset, 1, "\xC3\xA9");
+
+                    EXPECT_EQ(utf8, ToUTF8(str));
+                    EXPECT_EQ(str, FromUTF8(utf8));
+                }
+                std::string ascii(length, 'a');
+                EXPECT_EQ(ascii, ToUTF8(ascii));
+                EXPECT_EQ(ascii, FromUTF8(ascii));
+            }
+        }
+
+        // Every byte value, at every position of strings long enough to cross
+        // the vector and word boundaries of the case-folding kernels.
+        TEST(HelpersTest, foldingShouldOnlyLowerAsciiLettersAtAnyOffset) {
+            for (size_t length = 1; length < 72; length += 7) {
+                for (size_t offset = 0; offset < length; ++offset) {
+                    for (unsigned int byte = 1; byte < 256; ++byte) {
+                        std::string str(length, 'Q');
+                        str[offset] = static_cast<char>(byte);
+
+                        std::string expected(length, 'q');
+                        expected[offset] = (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte + 0x20) : static_cast<char>(byte);
+
+                        ASSERT_EQ(expected, FoldCase(str));
+                    }
+                }
+            }
+        }
+
+        TEST(HelpersTest, foldedEqualsShouldFindADifferenceAtAnyOffset) {
+            for (size_t length = 0; length < 72; ++length) {
+                std::string lower(length, 'x');
+                std::string upper(length, 'X');
+                EXPECT_TRUE(FoldedEquals(lower, upper));
+
+                for (size_t offset = 0; offset < length; ++offset) {
+                    std::string different(upper);
+                    different[offset] = 'Y';
+                    EXPECT_FALSE(FoldedEquals(lower, different));
+
+                    // Only letters differ by 0x20 when folded.
+                    std::string bracket(lower);
+                    bracket[offset] = '[';
+                    std::string brace(lower);
+                    brace[offset] = '{';
+                    EXPECT_FALSE(FoldedEquals(bracket, brace));
+
+                    std::string high(lower);
+                    high[offset] = '\xC9';
+                    std::string otherHigh(lower);
+                    otherHigh[offset] = '\xE9';
+                    EXPECT_FALSE(FoldedEquals(high, otherHigh));
+                }
+            }
+            EXPECT_FALSE(FoldedEquals("Blank.esm", "Blank.esm.ghost"));
+        }
+
+        TEST(HelpersTest, foldedHashShouldBeEqualForNamesThatDifferOnlyInCase) {
+            for (size_t length = 0; length < 72; ++length) {
+                std::string lower, upper;
+                for (size_t i = 0; i < length; ++i) {
+                    lower += static_cast<char>('a' + i % 26);
+                    upper += static_cast<char>('A' + i % 26);
+                }
+
+                EXPECT_EQ(FoldedHash(lower), FoldedHash(upper));
+                if (length > 0) {
+                    EXPECT_NE(FoldedHash(lower), FoldedHash(lower.substr(1)));
+                }
+            }
+            EXPECT_NE(FoldedHash("a"), FoldedHash(std::string("a\0", 2)));
+        }
+
+        TEST(HelpersTest, foldedEndsWithShouldIgnoreCase) {
+            EXPECT_TRUE(FoldedEndsWith("Blank.ESM", ".esm"));
+            EXPECT_TRUE(FoldedEndsWith("Blank.esm", ".ESM"));
+            EXPECT_TRUE(FoldedEndsWith(".esp", ".esp"));
+            EXPECT_TRUE(FoldedEndsWith("Blank.esp", ""));
+            EXPECT_FALSE(FoldedEndsWith("Blank.esm.ghost", ".esm"));
+            EXPECT_FALSE(FoldedEndsWith("esp", ".esp"));
+            EXPECT_FALSE(FoldedEndsWith("Blank.es\xCD", ".esm"));
+        }
+
+        TEST(HelpersTest, forEachLineShouldSkipBlankAndCommentLinesAndStripCarriageReturns) {
+            std::string buffer("Blank.esm\r\n\r\n# Blank.esp\n\nBlank - Different.esm\n\rBlank.esp");
+            std::vector<std::string> lines;
+            ForEachLine(buffer, [&](boost::string_ref line) {
+                lines.push_back(line.to_string());
+            });
+
+            EXPECT_EQ(std::vector<std::string>({
+                "Blank.esm",
+                "Blank - Different.esm",
+                "\rBlank.esp",
+            }), lines);
+        }
+
+        TEST(HelpersTest, forEachLineShouldGiveViewsIntoTheBuffer) {
+            std::string buffer("Blank.esm\n");
+            ForEachLine(buffer, [&](boost::string_ref line) {
+                EXPECT_EQ(buffer.data(), line.data());
+                EXPECT_EQ(9, line.length());
+            });
+
+            size_t count = 0;
+            ForEachLine(std::string(), [&](boost::string_ref) { ++count; });
+            ForEachLine(std::string("\n\r\n#\n"), [&](boost::string_ref) { ++count; });
+            EXPECT_EQ(0, count);
+        }
+
+        TEST(HelpersTest, fileToBufferShouldReadTheWholeFile) {
+            boost::filesystem::path file("helpers test file.txt");
+            std::string contents("#Comment\nBlank.esm\n\0Blank.esp", 29);
+            for (size_t i = 0; i < 1000; ++i)
+                contents += "\nBlank - Master Dependent.esp";
+            bufferToFile(file, contents, LIBLO_DURABILITY_NONE);
+
+            std::string buffer("Not replaced");
+            fileToBuffer(file, buffer);
+            boost::filesystem::remove(file);
+            EXPECT_EQ(contents, buffer);
+
+            fileToBuffer(file, buffer);
+            EXPECT_TRUE(buffer.empty());
+        }
+
+#ifndef _WIN32
+        TEST(HelpersTest, bufferToFileShouldReplaceTheFileASymlinkPointsTo) {
+            boost::filesystem::path file("helpers test target.txt");
+            boost::filesystem::path link("helpers test link.txt");
+            bufferToFile(file, "Blank.esm\n", LIBLO_DURABILITY_NONE);
+            boost::filesystem::create_symlink(file, link);
+
+            bufferToFile(link, "Blank.esp\n", LIBLO_DURABILITY_NONE);
+
+            EXPECT_TRUE(boost::filesystem::is_symlink(link));
+            std::string buffer;
+            fileToBuffer(file, buffer);
+            boost::filesystem::remove(link);
+            boost::filesystem::remove(file);
+            EXPECT_EQ("Blank.esp\n", buffer);
+        }
+#endif
+
+        TEST(HelpersTest, scanIniShouldTrackSectionsAndTrimSettings) {
+            std::string buffer(
+                "key0=unnamed\r\n"
+                "; comment=ignored\n"
+                "  [ Game Files ]  \n"
+                "no equals sign\n"
+                "\tGameFile0 =  Blank.esm \r\n"
+                "empty=\n"
+                "[General]\n"
+                "sKey=a=b");
+
+            std::vector<std::string> settings;
+            ScanIni(buffer, [&](const IniSetting& setting) {
+                settings.push_back(setting.section.to_string() + "|" + setting.key.to_string() + "|" + setting.value.to_string());
+                return true;
+            });
+
+            EXPECT_EQ(std::vector<std::string>({
+                "|key0|unnamed",
+                "Game Files|GameFile0|Blank.esm",
+                "Game Files|empty|",
+                "General|sKey|a=b",
+            }), settings);
+        }
+
+        TEST(HelpersTest, scanIniShouldStopWhenTheFunctionReturnsFalse) {
+            size_t count = 0;
+            ScanIni("[General]\na=1\nb=2\nc=3\n", [&](const IniSetting& setting) {
+                ++count;
+                return !FoldedEquals(setting.key, "B");
+            });
+            EXPECT_EQ(2, count);
+        }
+    }
+}
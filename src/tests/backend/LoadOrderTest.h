@@ -30,6 +30,10 @@ along with libloadorder.  If not, see
 #include "backend/LoadOrder.h"
 #include "backend/helpers.h"
 
+#include <algorithm>
+
+#include <boost/algorithm/string.hpp>
+
 namespace liblo {
     namespace test {
         class LoadOrderTest : public ::testing::TestWithParam<unsigned int> {
@@ -614,6 +618,7 @@ namespace liblo {
             // here because it's too expensive to do for every test.
             for (size_t i = 0; i < LoadOrder::maxActivePlugins; ++i) {
                 EXPECT_NO_THROW(boost::filesystem::copy_file(gameHandle.PluginsFolder() / blankEsp, gameHandle.PluginsFolder() / (std::to_string(i) + ".esp")));
+                gameHandle.InvalidatePluginData();
                 EXPECT_NO_THROW(loadOrder.activate(std::to_string(i) + ".esp", gameHandle));
             }
 
@@ -628,6 +633,7 @@ namespace liblo {
             // here because it's too expensive to do for every test.
             for (size_t i = 0; i < LoadOrder::maxActivePlugins; ++i) {
                 EXPECT_NO_THROW(boost::filesystem::copy_file(gameHandle.PluginsFolder() / blankEsp, gameHandle.PluginsFolder() / (std::to_string(i) + ".esp")));
+                gameHandle.InvalidatePluginData();
                 EXPECT_NO_THROW(loadOrder.activate(std::to_string(i) + ".esp", gameHandle));
             }
 
@@ -950,5 +956,199 @@ namespace liblo {
 
             EXPECT_FALSE(LoadOrder::isSynchronised(gameHandle));
         }
+
+        TEST_P(LoadOrderTest, isSynchronisedShouldIgnoreCaseAndAllButTheLastOfDuplicateLines) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.ActivePluginsFile());
+            out << boost::to_upper_copy(blankDifferentEsm) << std::endl
+                << boost::to_lower_copy(blankEsp) << std::endl
+                << boost::to_lower_copy(blankEsm) << std::endl
+                << updateEsm << std::endl
+                << blankDifferentEsm << std::endl;
+            out.close();
+
+            EXPECT_TRUE(LoadOrder::isSynchronised(gameHandle));
+        }
+
+        TEST_P(LoadOrderTest, isNotSynchronisedWhenTwoMastersAreListedInDifferentOrders) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.ActivePluginsFile());
+            out << blankDifferentEsm << std::endl
+                << blankEsm << std::endl;
+            out.close();
+
+            EXPECT_FALSE(LoadOrder::isSynchronised(gameHandle));
+        }
+
+        TEST_P(LoadOrderTest, isNotSynchronisedWhenAValidActivePluginIsMissingFromTheLoadOrderFile) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.LoadOrderFile());
+            out << gameHandle.MasterFile() << std::endl
+                << blankEsm << std::endl
+                << updateEsm << std::endl
+                << blankEsp << std::endl;
+            out.close();
+
+            out.open(gameHandle.ActivePluginsFile());
+            out << blankEsm << std::endl
+                << blankEsp << std::endl
+                << "Blank - Different.esp" << std::endl;
+            out.close();
+
+            EXPECT_FALSE(LoadOrder::isSynchronised(gameHandle));
+        }
+
+        TEST_P(LoadOrderTest, isSynchronisedShouldAddTheGameMasterAndUpdateEsmToBothFilesAsLoadingDoes) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.LoadOrderFile());
+            out << blankEsm << std::endl
+                << blankEsp << std::endl;
+            out.close();
+
+            out.open(gameHandle.ActivePluginsFile());
+            out << blankEsm << std::endl
+                << blankEsp << std::endl;
+            out.close();
+
+            EXPECT_TRUE(LoadOrder::isSynchronised(gameHandle));
+        }
+
+        TEST_P(LoadOrderTest, isSynchronisedShouldIgnoreInvalidActivePluginsMissingFromTheLoadOrderFile) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.ActivePluginsFile(), std::ios_base::app);
+            out << missingPlugin << std::endl;
+            out.close();
+
+            EXPECT_TRUE(LoadOrder::isSynchronised(gameHandle));
+        }
+
+        TEST_P(LoadOrderTest, isSynchronisedShouldKeepTheListsItReadsForTheNextLoad) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            ASSERT_TRUE(LoadOrder::isSynchronised(gameHandle));
+
+            std::vector<std::string> lines;
+            EXPECT_TRUE(gameHandle.TakePluginList(gameHandle.LoadOrderFile(), lines));
+            EXPECT_EQ(gameHandle.MasterFile(), lines.front());
+
+            // Lists are only kept for one load.
+            EXPECT_FALSE(gameHandle.TakePluginList(gameHandle.LoadOrderFile(), lines));
+        }
+
+        TEST_P(LoadOrderTest, keptListsShouldNotBeUsedIfTheirFileHasChanged) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            ASSERT_TRUE(LoadOrder::isSynchronised(gameHandle));
+
+            boost::filesystem::ofstream out(gameHandle.LoadOrderFile(), std::ios_base::app);
+            out << blankEsm << std::endl;
+            out.close();
+
+            std::vector<std::string> lines;
+            EXPECT_FALSE(gameHandle.TakePluginList(gameHandle.LoadOrderFile(), lines));
+
+            // Blank.esm is now listed last, so it loads after the other masters.
+            EXPECT_NO_THROW(loadOrder.Load(gameHandle));
+            EXPECT_LT(loadOrder.getPosition(blankDifferentEsm), loadOrder.getPosition(blankEsm));
+        }
+
+        TEST_P(LoadOrderTest, loadingShouldKeepTheLastOfDuplicateLinesAndMoveMastersFirst) {
+            if (gameHandle.LoadOrderMethod() == LIBLO_METHOD_TIMESTAMP)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.LoadOrderFile());
+            out << blankEsp << std::endl
+                << boost::to_upper_copy(blankEsm) << std::endl
+                << gameHandle.MasterFile() << std::endl
+                << invalidPlugin << std::endl
+                << blankDifferentEsm << std::endl
+                << blankEsm << std::endl;
+            out.close();
+
+            ASSERT_NO_THROW(loadOrder.Load(gameHandle));
+            std::vector<std::string> plugins(loadOrder.getLoadOrder());
+
+            EXPECT_EQ(gameHandle.MasterFile(), plugins.front());
+            EXPECT_LT(loadOrder.getPosition(blankDifferentEsm), loadOrder.getPosition(blankEsm));
+            EXPECT_LT(loadOrder.getPosition(blankEsm), loadOrder.getPosition(blankEsp));
+            EXPECT_EQ(1, std::count(std::begin(plugins), std::end(plugins), blankEsm));
+            EXPECT_EQ(0, std::count(std::begin(plugins), std::end(plugins), boost::to_upper_copy(blankEsm)));
+            EXPECT_EQ(plugins.size(), loadOrder.getPosition(invalidPlugin));
+        }
+
+        TEST_P(LoadOrderTest, morrowindActivePluginsShouldOnlyBeReadFromTheGameFilesSection) {
+            if (GetParam() != LIBLO_GAME_TES3)
+                return;
+
+            boost::filesystem::ofstream out(gameHandle.ActivePluginsFile());
+            out << "[General]" << std::endl
+                << "GameFile0=" << blankEsp << std::endl
+                << "[game files]" << std::endl
+                << "; GameFile0=" << blankEsp << std::endl
+                << "GameFile0=" << blankEsm << std::endl
+                << "gamefile1 = " << blankDifferentEsm << std::endl
+                << "GameFile2=" << "Blank.txt" << std::endl
+                << "GameFile=" << blankEsp << std::endl
+                << "[Archives]" << std::endl
+                << "GameFile3=" << blankEsp << std::endl;
+            out.close();
+
+            ASSERT_NO_THROW(gameHandle.activePlugins.Load(gameHandle));
+
+            std::vector<std::string> active;
+            for (const auto& plugin : gameHandle.activePlugins.Ordered())
+                active.push_back(plugin.Name());
+            EXPECT_EQ(std::vector<std::string>({ blankEsm, blankDifferentEsm }), active);
+        }
+
+        TEST_P(LoadOrderTest, anInvalidPluginShouldGiveTheSameErrorWhetherOrNotItsHeaderIsCached) {
+            auto readError = [&](const _lo_game_handle_int& handle) {
+                try {
+                    Plugin(invalidPlugin).IsMasterFile(handle);
+                }
+                catch (std::exception& e) {
+                    return std::string(e.what());
+                }
+                return std::string();
+            };
+
+            gameHandle.SetHeaderCacheEnabled(true);
+            std::string uncachedError = readError(gameHandle);
+            EXPECT_FALSE(uncachedError.empty());
+            gameHandle.SaveHeaderCache();
+
+            _lo_game_handle_int cachedHandle(GetParam(), getGamePath(GetParam()));
+            cachedHandle.SetLocalAppData(getLocalPath(GetParam()));
+            cachedHandle.SetHeaderCacheEnabled(true);
+            EXPECT_EQ(uncachedError, readError(cachedHandle));
+
+            ASSERT_NO_THROW(boost::filesystem::remove(getLocalPath(GetParam()) / "libloadorder.cache"));
+        }
+
+        TEST_P(LoadOrderTest, revertingADeactivationShouldRestoreThePluginsListedPosition) {
+            ASSERT_NO_THROW(gameHandle.BeginTransaction());
+            const std::vector<Plugin> ordered(gameHandle.activePlugins.Ordered());
+            ASSERT_LT(2, ordered.size());
+
+            gameHandle.BeginChange();
+            gameHandle.KeepActiveStateForUndo(ordered[1]);
+            gameHandle.activePlugins.erase(gameHandle.activePlugins.find(ordered[1]));
+            gameHandle.RevertChange();
+
+            EXPECT_EQ(ordered, gameHandle.activePlugins.Ordered());
+            ASSERT_NO_THROW(gameHandle.AbortTransaction());
+        }
     }
 }
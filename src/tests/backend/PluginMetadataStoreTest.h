@@ -0,0 +1,86 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+
+#include <gtest/gtest.h>
+
+#include "backend/PluginMetadataStore.h"
+#include "backend/helpers.h"
+
+namespace liblo {
+    namespace test {
+        class PluginMetadataStoreTest : public ::testing::Test {
+        protected:
+            PluginMetadataStore store;
+
+            inline size_t getId(const std::string& pluginName) {
+                return store.getId(pluginName, FoldedHash(pluginName));
+            }
+        };
+
+        TEST_F(PluginMetadataStoreTest, gettingTheIdOfAPluginTwiceShouldReturnTheSameId) {
+            EXPECT_EQ(getId("Blank.esm"), getId("Blank.esm"));
+        }
+
+        TEST_F(PluginMetadataStoreTest, gettingPluginIdsShouldBeCaseInsensitive) {
+            EXPECT_EQ(getId("Blank.esm"), getId("blank.ESM"));
+        }
+
+        TEST_F(PluginMetadataStoreTest, differentPluginsShouldHaveDifferentIds) {
+            EXPECT_NE(getId("Blank.esm"), getId("Blank.esp"));
+        }
+
+        TEST_F(PluginMetadataStoreTest, internedNamesShouldKeepTheirFirstSpelling) {
+            size_t id = getId("Blank.esm");
+            getId("blank.ESM");
+
+            EXPECT_EQ("Blank.esm", store.get(id).name);
+            EXPECT_EQ("blank.esm", store.get(id).folded);
+            EXPECT_EQ(FoldedHash("BLANK.ESM"), store.get(id).hash);
+        }
+
+        TEST_F(PluginMetadataStoreTest, differentNamesWithTheSameHashShouldHaveDifferentIds) {
+            EXPECT_NE(store.getId("Blank.esm", 1), store.getId("Blank.esp", 1));
+            EXPECT_EQ(store.getId("Blank.esm", 1), store.getId("BLANK.esm", 1));
+        }
+
+        TEST_F(PluginMetadataStoreTest, invalidatingTheStoreShouldForgetFactsButKeepIds) {
+            size_t id = getId("Blank.esm");
+            store.get(id).headerRead = true;
+            store.get(id).header.isMaster = true;
+
+            store.invalidate();
+
+            EXPECT_EQ(id, getId("Blank.esm"));
+            EXPECT_EQ("Blank.esm", store.get(id).name);
+            EXPECT_FALSE(store.get(id).headerRead);
+            EXPECT_FALSE(store.get(id).header.isMaster);
+        }
+
+        TEST_F(PluginMetadataStoreTest, storesShouldHaveDifferentSerialNumbers) {
+            PluginMetadataStore other;
+            EXPECT_NE(store.Serial(), other.Serial());
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+#include <gtest/gtest.h>
+
+#include "backend/PluginSequence.h"
+
+namespace liblo {
+    namespace test {
+        class PluginSequenceTest : public ::testing::Test {
+        protected:
+            inline virtual void SetUp() {
+                sequence.push_back(Plugin("Blank.esm"), true);
+                sequence.push_back(Plugin("Blank.esp"), false);
+                sequence.push_back(Plugin("Blank - Different.esp"), false);
+            }
+
+            inline std::vector<std::string> names() const {
+                std::vector<std::string> names;
+                for (const auto& plugin : sequence)
+                    names.push_back(plugin.Name());
+                return names;
+            }
+
+            PluginSequence sequence;
+        };
+
+        TEST_F(PluginSequenceTest, findingShouldBeCaseInsensitive) {
+            EXPECT_EQ(1, sequence.find(Plugin("blank.ESP")));
+            EXPECT_TRUE(sequence.contains(Plugin("BLANK.esm")));
+        }
+
+        TEST_F(PluginSequenceTest, findingAnUnlistedPluginShouldReturnTheSize) {
+            EXPECT_EQ(3, sequence.find(Plugin("Blank - Master Dependent.esp")));
+            EXPECT_FALSE(sequence.contains(Plugin("Blank - Master Dependent.esp")));
+        }
+
+        TEST_F(PluginSequenceTest, accessingAPositionPastTheEndShouldThrow) {
+            EXPECT_THROW(sequence.at(3), std::out_of_range);
+            EXPECT_THROW(sequence.erase(3), std::out_of_range);
+            EXPECT_THROW(sequence.insert(4, Plugin("Blank.esm"), true), std::out_of_range);
+        }
+
+        TEST_F(PluginSequenceTest, insertingShouldShiftLaterPositions) {
+            sequence.insert(1, Plugin("Blank - Different.esm"), true);
+
+            EXPECT_EQ(std::vector<std::string>({
+                "Blank.esm",
+                "Blank - Different.esm",
+                "Blank.esp",
+                "Blank - Different.esp",
+            }), names());
+            EXPECT_EQ(1, sequence.find(Plugin("Blank - Different.esm")));
+            EXPECT_EQ(3, sequence.find(Plugin("Blank - Different.esp")));
+            EXPECT_EQ(2, sequence.masterCount());
+        }
+
+        TEST_F(PluginSequenceTest, insertingSeveralPluginsShouldKeepTheirOrder) {
+            sequence.insert(1, std::vector<Plugin>({
+                Plugin("Blank - Different.esm"),
+                Plugin("Blank - Master Dependent.esm"),
+            }), true);
+            sequence.insert(4, std::vector<Plugin>(), false);
+
+            EXPECT_EQ(std::vector<std::string>({
+                "Blank.esm",
+                "Blank - Different.esm",
+                "Blank - Master Dependent.esm",
+                "Blank.esp",
+                "Blank - Different.esp",
+            }), names());
+            EXPECT_EQ(2, sequence.find(Plugin("Blank - Master Dependent.esm")));
+            EXPECT_EQ(4, sequence.find(Plugin("Blank - Different.esp")));
+            EXPECT_EQ(3, sequence.masterCount());
+            EXPECT_THROW(sequence.insert(6, std::vector<Plugin>(), false), std::out_of_range);
+        }
+
+        TEST_F(PluginSequenceTest, erasingShouldUnindexThePluginAndShiftLaterPositions) {
+            sequence.erase(0);
+
+            EXPECT_FALSE(sequence.contains(Plugin("Blank.esm")));
+            EXPECT_EQ(0, sequence.find(Plugin("Blank.esp")));
+            EXPECT_EQ(1, sequence.find(Plugin("Blank - Different.esp")));
+            EXPECT_EQ(0, sequence.masterCount());
+        }
+
+        TEST_F(PluginSequenceTest, movingAPluginShouldKeepItsMasterStatus) {
+            sequence.erase(2);
+            sequence.insert(1, Plugin("Blank - Different.esp"), false);
+
+            EXPECT_EQ("Blank - Different.esp", sequence.at(1).Name());
+            EXPECT_FALSE(sequence.isMaster(1));
+            EXPECT_TRUE(sequence.isMaster(0));
+            EXPECT_EQ(1, sequence.masterCount());
+        }
+
+        TEST_F(PluginSequenceTest, duplicatesShouldBeIndexedAtTheirFirstPosition) {
+            sequence.push_back(Plugin("Blank.esm"), true);
+            EXPECT_EQ(0, sequence.find(Plugin("Blank.esm")));
+
+            sequence.erase(0);
+            EXPECT_EQ(2, sequence.find(Plugin("Blank.esm")));
+        }
+
+        TEST_F(PluginSequenceTest, removingDuplicatesShouldKeepTheLastEntry) {
+            sequence.push_back(Plugin("Blank.esm"), true);
+            sequence.removeDuplicates();
+
+            ASSERT_EQ(3, sequence.size());
+            EXPECT_EQ("Blank.esm", sequence.at(2).Name());
+            EXPECT_EQ(2, sequence.find(Plugin("Blank.esm")));
+            EXPECT_EQ(0, sequence.find(Plugin("Blank.esp")));
+            EXPECT_EQ(1, sequence.masterCount());
+        }
+
+        TEST_F(PluginSequenceTest, sortingShouldReindexPositions) {
+            sequence.sort([](const Plugin& lhs, const Plugin& rhs) {
+                return lhs.Name() < rhs.Name();
+            });
+
+            EXPECT_EQ(0, sequence.find(Plugin("Blank - Different.esp")));
+            EXPECT_EQ(1, sequence.find(Plugin("Blank.esm")));
+            EXPECT_EQ(2, sequence.find(Plugin("Blank.esp")));
+            EXPECT_TRUE(sequence.isMaster(1));
+        }
+
+        TEST_F(PluginSequenceTest, partitioningMastersShouldReclassifyAndStablyMoveThem) {
+            sequence.partitionMasters([](const Plugin& plugin) {
+                return plugin.Name() != "Blank.esp";
+            });
+
+            EXPECT_EQ(std::vector<std::string>({
+                "Blank.esm",
+                "Blank - Different.esp",
+                "Blank.esp",
+            }), names());
+            EXPECT_EQ(2, sequence.masterCount());
+        }
+
+        TEST_F(PluginSequenceTest, positionsShouldMatchAVectorAfterManyEdits) {
+            std::vector<std::string> expected(names());
+            std::minstd_rand random;
+            for (size_t i = 0; i < 2000; ++i) {
+                if (expected.empty() || random() % 3 != 0) {
+                    std::string name = "Plugin" + std::to_string(i) + ".esp";
+                    size_t position = random() % (expected.size() + 1);
+                    sequence.insert(position, Plugin(name), false);
+                    expected.insert(expected.begin() + position, name);
+                }
+                else {
+                    size_t position = random() % expected.size();
+                    sequence.erase(position);
+                    expected.erase(expected.begin() + position);
+                }
+            }
+
+            ASSERT_EQ(expected, names());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                EXPECT_EQ(i, sequence.find(Plugin(expected[i])));
+                EXPECT_EQ(expected[i], sequence.at(i).Name());
+            }
+        }
+    }
+}
@@ -64,5 +64,17 @@ namespace liblo {
             plugin.deactivate();
             EXPECT_FALSE(plugin.isActive());
         }
+
+        TEST_F(PluginTest, pluginsShouldCompareCaseInsensitively) {
+            EXPECT_EQ(Plugin("Blank.esm"), Plugin("blank.ESM"));
+            EXPECT_NE(Plugin("Blank.esm"), Plugin("Blank.esp"));
+            EXPECT_EQ(Plugin("Blank.esm").Hash(), Plugin("BLANK.esm").Hash());
+        }
+
+        TEST_F(PluginTest, constructingAPluginShouldTrimGhostExtensionsAndCarriageReturns) {
+            EXPECT_EQ("Blank.esm", Plugin("Blank.esm.ghost").Name());
+            EXPECT_EQ("Blank.esm", Plugin("Blank.esm\r").Name());
+            EXPECT_EQ(Plugin("Blank.esm").Hash(), Plugin("Blank.esm.ghost").Hash());
+        }
     }
 }
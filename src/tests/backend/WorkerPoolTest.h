@@ -0,0 +1,81 @@
+/*  libloadorder
+
+    A library for reading and writing the load order of plugin files for
+    TES III: Morrowind, TES IV: Oblivion, TES V: Skyrim, Fallout 3 and
+    Fallout: New Vegas.
+
+    Copyright (C) 2012    WrinklyNinja
+
+    This file is part of libloadorder.
+
+    libloadorder is free software: you can redistribute
+    it and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation, either version 3 of
+    the License, or (at your option) any later version.
+
+    libloadorder is distributed in the hope that it will
+    be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libloadorder.  If not, see
+    <http://www.gnu.org/licenses/>.
+    */
+#include <gtest/gtest.h>
+
+#include "backend/WorkerPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace liblo {
+    namespace test {
+        class WorkerPoolTest : public ::testing::Test {
+        protected:
+            WorkerPool pool;
+        };
+
+        TEST_F(WorkerPoolTest, aNewPoolShouldOnlyUseTheCallingThread) {
+            EXPECT_EQ(1, pool.Concurrency());
+        }
+
+        TEST_F(WorkerPoolTest, resizingThePoolShouldChangeItsConcurrency) {
+            pool.Resize(4);
+            EXPECT_EQ(4, pool.Concurrency());
+
+            pool.Resize(0);
+            EXPECT_EQ(1, pool.Concurrency());
+        }
+
+        TEST_F(WorkerPoolTest, parallelForShouldRunEveryIndexOnce) {
+            pool.Resize(4);
+
+            for (int batch = 0; batch < 20; ++batch) {
+                std::vector<std::atomic<int>> calls(100);
+                for (auto& count : calls)
+                    count = 0;
+
+                pool.ParallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+
+                for (const auto& count : calls)
+                    EXPECT_EQ(1, count);
+            }
+        }
+
+        TEST_F(WorkerPoolTest, parallelForShouldRethrowTaskExceptions) {
+            pool.Resize(4);
+
+            EXPECT_THROW(pool.ParallelFor(100, [](size_t i) {
+                if (i == 50)
+                    throw std::runtime_error("task failed");
+            }), std::runtime_error);
+
+            // The pool should still be usable.
+            std::atomic<size_t> calls(0);
+            pool.ParallelFor(10, [&](size_t) { ++calls; });
+            EXPECT_EQ(10, calls);
+        }
+    }
+}
@@ -27,9 +27,16 @@
 #include "api/libloadorder.h"
 #include "api/activeplugins.h"
 #include "api/loadorder.h"
+#include "api/threadsafety.h"
 #include "backend/GameHandleTest.h"
+#include "backend/HelpersTest.h"
 #include "backend/LoadOrderTest.h"
 #include "backend/PluginTest.h"
+#include "backend/PluginSequenceTest.h"
+#include "backend/ChangeWatcherTest.h"
+#include "backend/DataDirSnapshotTest.h"
+#include "backend/PluginMetadataStoreTest.h"
+#include "backend/WorkerPoolTest.h"
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);